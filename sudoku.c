@@ -11,8 +11,19 @@
 
 #include "colors_definitions.h"
 #include "sudoku.h"
+#include "sudoku_hint.h"
+#include "sudoku_archive.h"
+#include "sudoku_variant.h"
+#include "sudoku_journal.h"
 
 #define SUDOKU_DIMENSION 9
+#define SOLUTION_CACHE_FILE ".sudoku_cache"
+#define SOLUTION_CACHE_CAPACITY 4096
+#define PUZZLE_ARCHIVE_FILE "puzzles.sdka"
+#define SESSION_JOURNAL_FILE ".sudoku_journal"
+#define NOGOOD_MAX_LITERALS 8
+#define NOGOOD_WAYS 4
+#define VARIANT_FILL_BUDGET 10000
 /*  ==================================  */
 /*  ENUMERATIONS & TYPES                */
 /*  ==================================  */
@@ -22,6 +33,31 @@ typedef enum
     INITIATE_FROM_INITIALIZATION
 } print_location_t;
 
+typedef struct Conflict_Set
+{
+    unsigned long long cells[2]; /* Bit per cell whose digit took part in a dead end */
+} conflict_set_t;
+
+typedef struct Nogood
+{
+    unsigned short literals[NOGOOD_MAX_LITERALS]; /* cell * 9 + digit - 1 */
+    unsigned char size;
+    unsigned char used;
+} nogood_t;
+
+typedef struct Learning_State
+{
+    /* Set-associative store, indexed by the literal that completes the nogood */
+    nogood_t nogoods[SUDOKU_CELLS * SUDOKU_DIMENSION][NOGOOD_WAYS];
+    unsigned char next_way[SUDOKU_CELLS * SUDOKU_DIMENSION];
+    size_t order[SUDOKU_CELLS];
+    int depth_of[SUDOKU_CELLS]; /* -1 for givens */
+    size_t empty_count;
+    const unsigned char *peers[SUDOKU_CELLS]; /* Peer lists of the compiled rules */
+    size_t peer_count[SUDOKU_CELLS];
+    int has_cages; /* Cage sums can rule a digit out with no peer holding it */
+} learning_state_t;
+
 struct Sudoku_Grid
 {
     unsigned int board[SUDOKU_DIMENSION][SUDOKU_DIMENSION];
@@ -29,6 +65,11 @@ struct Sudoku_Grid
     unsigned int populated_cells_count;
     unsigned int current_row;
     unsigned int current_col;
+    sudoku_variant_t *variant; /* Compiled rules, kept in step with the board */
+    sudoku_hint_engine_t *hint_engine;
+    sudoku_hint_t hint;
+    int has_hint;
+    sudoku_journal_t *journal; /* Records the moves of the game, NULL when nothing is recorded */
 };
 
 /*  ==================================  */
@@ -37,35 +78,55 @@ struct Sudoku_Grid
 unsigned int solved_board[SUDOKU_DIMENSION][SUDOKU_DIMENSION];
 unsigned int mask[SUDOKU_DIMENSION][SUDOKU_DIMENSION];
 print_location_t print_location = INITIATE_FROM_MAIN;
+sudoku_cache_t *solution_cache = NULL;
+solver_stats_t solver_stats;
 
 /*  ==================================  */
 /*  Daclaration Static Functions        */
 /*  ==================================  */
-static sudoku_grid_t *CreateSudokuGrid();
+static sudoku_grid_t *CreateSudokuGrid(const sudoku_variant_t *variant);
 static void DestroySudokuGrid(sudoku_grid_t *sudoku_grid);
 static void InitializeSudokuGrid(sudoku_grid_t *sudoku_grid, int difficulty_level);
+static int InitializeSudokuGridFromArchive(sudoku_grid_t *sudoku_grid, int difficulty_level);
+static void InitializeVariantSudokuGrid(sudoku_grid_t *sudoku_grid, int difficulty_level);
+static int FillRandomGrid(sudoku_grid_t *sudoku_grid, unsigned long *budget);
 static int InitializeSudokuGridByUser(sudoku_grid_t *sudoku_grid);
 static void PrintSudokuGrid(sudoku_grid_t *sudoku_grid);
 static void GetCoordinates(sudoku_grid_t *sudoku_grid, size_t *square_y, size_t *square_x);
-static void GetBoxCenter(size_t y, size_t x, size_t *y_center, size_t *x_center);
-static int IsNumberInBox(sudoku_grid_t *sudoku_grid, unsigned int number, size_t y, size_t x);
-static int IsNumberInRowLine(sudoku_grid_t *sudoku_grid, unsigned int number, size_t x);
-static int IsNumberInColLine(sudoku_grid_t *sudoku_grid, unsigned int number, size_t y);
 static int IsLegalValue(sudoku_grid_t *sudoku_grid, unsigned int number, size_t y, size_t x);
+static void SetCellValue(sudoku_grid_t *sudoku_grid, size_t row, size_t col, unsigned int number);
 static void MoveCursor(sudoku_grid_t *sudoku_grid, int direction);
 static void RemoveNumber(sudoku_grid_t *sudoku_grid);
 static void AddNumber(sudoku_grid_t *sudoku_grid, unsigned int number);
-static int SolveSudoku(sudoku_grid_t *sudoku_grid, size_t row, size_t col);
+static void CountSolutions(sudoku_grid_t *sudoku_grid, size_t row, size_t col, unsigned int *solution_count, unsigned int limit);
+static unsigned int FindSolution(sudoku_grid_t *sudoku_grid, enum solver_mode mode, int use_cache);
+static int CountSolutionsLearning(sudoku_grid_t *sudoku_grid, learning_state_t *state, size_t depth,
+                                  unsigned int *solution_count, unsigned int limit, conflict_set_t *conflict);
+static void InitializeLearningState(sudoku_grid_t *sudoku_grid, learning_state_t *state);
+static int FindCulprit(sudoku_grid_t *sudoku_grid, learning_state_t *state, size_t cell, unsigned int number);
+static void AddCageReasons(sudoku_grid_t *sudoku_grid, learning_state_t *state, size_t cell, conflict_set_t *reasons);
+static void SetDecision(sudoku_grid_t *sudoku_grid, learning_state_t *state, size_t row, size_t col, unsigned int number);
+static int MatchNogood(sudoku_grid_t *sudoku_grid, learning_state_t *state, size_t cell, unsigned int number, conflict_set_t *conflict);
+static void RecordNogood(sudoku_grid_t *sudoku_grid, learning_state_t *state, const conflict_set_t *conflict);
+static void StoreSolution(sudoku_grid_t *sudoku_grid);
+static int OpenSolutionCache();
+static void CloseSolutionCache(int owns_cache);
 static int HasPossibleValue(sudoku_grid_t *sudoku_grid, size_t row, size_t col);
 static int AllCellsHavePossibleValues(sudoku_grid_t *sudoku_grid);
 static unsigned int GetPopulatedCellsCount(int difficulty_level);
+static void ReloadHintEngine(sudoku_grid_t *sudoku_grid);
+static void ShowHint(sudoku_grid_t *sudoku_grid);
+static void StartSessionJournal(sudoku_grid_t *sudoku_grid, unsigned int rules);
+static sudoku_grid_t *ResumeSudokuGame();
+static void RecordCursor(sudoku_grid_t *sudoku_grid);
 
 /*  =================================   */
 /*  API Functions Implementation        */
 /*  =================================   */
 void InitiateSudokuGame()
 {
-    sudoku_grid_t *sudoku = CreateSudokuGrid();
+    sudoku_grid_t *sudoku = NULL;
+    sudoku_variant_t *variant = NULL;
 
     size_t row = 0;
     size_t col = 0;
@@ -75,6 +136,10 @@ void InitiateSudokuGame()
     int digit = 0;
 
     int difficulty_level;
+    int rules = 0;
+    int owns_cache = 0;
+
+    unsigned int variant_rules = VARIANT_CLASSIC;
 
     printf("Choose difficulty level then press Enter:\r\n");
     printf("1. Easy\r\n");
@@ -82,9 +147,40 @@ void InitiateSudokuGame()
     printf("3. Hard\r\n");
     printf("4. Expert\r\n");
     printf("5. Extreme\r\n");
+    printf("6. Resume the last game\r\n");
 
     scanf("%d", &difficulty_level);
 
+    if (6 == difficulty_level)
+    {
+        sudoku = ResumeSudokuGame();
+        if (NULL == sudoku)
+        {
+            printf("There is no game to resume.\r\n");
+            return;
+        }
+    }
+    else
+    {
+        printf("Choose the rules then press Enter:\r\n");
+        printf("1. Classic\r\n");
+        printf("2. Diagonal (X-Sudoku)\r\n");
+        printf("3. Windoku\r\n");
+
+        scanf("%d", &rules);
+
+        variant_rules = (2 == rules) ? VARIANT_DIAGONAL : (3 == rules) ? VARIANT_WINDOKU : VARIANT_CLASSIC;
+        variant = SudokuVariantCreate(variant_rules);
+        if (NULL == variant)
+        {
+            fprintf(stderr, "Memory allocation failed.\r\n");
+            exit(EXIT_FAILURE);
+        }
+
+        sudoku = CreateSudokuGrid(variant);
+        SudokuVariantDestroy(variant);
+    }
+
     initscr(); /* Initialize ncurses */
     raw();
     nodelay(stdscr, TRUE);
@@ -97,7 +193,22 @@ void InitiateSudokuGame()
 
     srand((unsigned int)time(NULL));
 
-    InitializeSudokuGrid(sudoku, difficulty_level);
+    owns_cache = OpenSolutionCache();
+
+    /* A resumed game has its board; a new one prefers a puzzle from the archive, generated if there is none */
+    if (NULL == sudoku->journal)
+    {
+        if (!SudokuVariantIsClassic(sudoku->variant))
+        {
+            InitializeVariantSudokuGrid(sudoku, difficulty_level);
+        }
+        else if (InitializeSudokuGridFromArchive(sudoku, difficulty_level))
+        {
+            InitializeSudokuGrid(sudoku, difficulty_level);
+        }
+
+        StartSessionJournal(sudoku, variant_rules);
+    }
 
     while ('q' != (input = getch()))
     {
@@ -112,6 +223,8 @@ void InitiateSudokuGame()
             continue;
         }
 
+        sudoku->has_hint = 0;
+
         switch (input)
         {
         case KEY_UP:
@@ -131,9 +244,18 @@ void InitiateSudokuGame()
             {
                 for (col = 0; col < sudoku->board_size; ++col)
                 {
-                    sudoku->board[row][col] = solved_board[row][col];
+                    if ((NULL != sudoku->journal) && (0 != solved_board[row][col]) &&
+                        (solved_board[row][col] != sudoku->board[row][col]))
+                    {
+                        SudokuJournalSetCell(sudoku->journal, row * SUDOKU_DIMENSION + col, solved_board[row][col]);
+                    }
+                    SetCellValue(sudoku, row, col, solved_board[row][col]);
                 }
             }
+            ReloadHintEngine(sudoku);
+            break;
+        case 'h':
+            ShowHint(sudoku);
             break;
         case '0': /* Allow the user to input '0' to clear a cell */
             RemoveNumber(sudoku);
@@ -148,18 +270,25 @@ void InitiateSudokuGame()
             break;
         }
 
+        /* One write per key, so a crash loses at most the key being handled */
+        if (NULL != sudoku->journal)
+        {
+            SudokuJournalFlush(sudoku->journal);
+        }
+
         /* Update the display or perform other tasks as needed */
         PrintSudokuGrid(sudoku);
     }
 
     endwin(); /* End ncurses mode */
 
+    CloseSolutionCache(owns_cache);
     DestroySudokuGrid(sudoku);
 }
 
 int SolveSudokuGrid()
 {
-    sudoku_grid_t *sudoku = CreateSudokuGrid();
+    sudoku_grid_t *sudoku = CreateSudokuGrid(NULL);
 
     size_t row = 0;
     size_t col = 0;
@@ -167,6 +296,7 @@ int SolveSudokuGrid()
     int input = 0;
     int flage = 0;
     int digit = 0;
+    int owns_cache = 0;
 
     initscr(); /* Initialize ncurses */
     raw();
@@ -180,10 +310,13 @@ int SolveSudokuGrid()
 
     srand((unsigned int)time(NULL));
 
+    owns_cache = OpenSolutionCache();
+
     if (InitializeSudokuGridByUser(sudoku))
     {
         system("clear");
         printf("The initialized board by the user has no solution.\r\n");
+        CloseSolutionCache(owns_cache);
         return 1;
     }
 
@@ -202,6 +335,8 @@ int SolveSudokuGrid()
             continue;
         }
 
+        sudoku->has_hint = 0;
+
         switch (input)
         {
         case KEY_UP:
@@ -221,9 +356,13 @@ int SolveSudokuGrid()
             {
                 for (col = 0; col < sudoku->board_size; ++col)
                 {
-                    sudoku->board[row][col] = solved_board[row][col];
+                    SetCellValue(sudoku, row, col, solved_board[row][col]);
                 }
             }
+            ReloadHintEngine(sudoku);
+            break;
+        case 'h':
+            ShowHint(sudoku);
             break;
         case '0': /* Allow the user to input '0' to clear a cell */
             RemoveNumber(sudoku);
@@ -244,19 +383,93 @@ int SolveSudokuGrid()
 
     endwin(); /* End ncurses mode */
 
+    CloseSolutionCache(owns_cache);
     DestroySudokuGrid(sudoku);
 
     return 0;
 }
 
+unsigned int SolveSudokuPuzzle(const unsigned char *puzzle, unsigned char *solution)
+{
+    return SolveSudokuPuzzleWithMode(puzzle, solution, NOGOOD_LEARNING, NULL);
+}
+
+unsigned int SolveSudokuPuzzleWithMode(const unsigned char *puzzle, unsigned char *solution,
+                                       enum solver_mode mode, solver_stats_t *stats)
+{
+    return SolveSudokuVariantPuzzle(NULL, puzzle, solution, mode, stats);
+}
+
+unsigned int SolveSudokuVariantPuzzle(const sudoku_variant_t *variant, const unsigned char *puzzle,
+                                      unsigned char *solution, enum solver_mode mode, solver_stats_t *stats)
+{
+    sudoku_grid_t *sudoku = CreateSudokuGrid(variant);
+
+    size_t row = 0;
+    size_t col = 0;
+
+    unsigned int number = 0;
+    unsigned int solution_count = 0;
+
+    for (row = 0; row < sudoku->board_size; ++row)
+    {
+        for (col = 0; col < sudoku->board_size; ++col)
+        {
+            number = puzzle[row * SUDOKU_DIMENSION + col];
+
+            if (0 != number)
+            {
+                /* A given that breaks the rules leaves the puzzle without a solution */
+                if ((number > sudoku->board_size) || (!IsLegalValue(sudoku, number, row, col)))
+                {
+                    DestroySudokuGrid(sudoku);
+                    return 0;
+                }
+
+                SetCellValue(sudoku, row, col, number);
+                ++sudoku->populated_cells_count;
+            }
+        }
+    }
+
+    solution_count = FindSolution(sudoku, mode, 1);
+
+    if (NULL != stats)
+    {
+        *stats = solver_stats;
+    }
+
+    if ((NULL != solution) && (0 != solution_count))
+    {
+        for (row = 0; row < sudoku->board_size; ++row)
+        {
+            for (col = 0; col < sudoku->board_size; ++col)
+            {
+                solution[row * SUDOKU_DIMENSION + col] = (unsigned char)solved_board[row][col];
+            }
+        }
+    }
+
+    DestroySudokuGrid(sudoku);
+
+    return solution_count;
+}
+
+void SetSolutionCache(sudoku_cache_t *cache)
+{
+    solution_cache = cache;
+}
+
 /*  =================================   */
 /*  Static Functions Implementation     */
 /*  =================================   */
-static sudoku_grid_t *CreateSudokuGrid()
+static sudoku_grid_t *CreateSudokuGrid(const sudoku_variant_t *variant)
 {
     size_t col = 0;
     size_t row = 0;
 
+    unsigned char empty_cells[SUDOKU_CELLS] = {0};
+
     sudoku_grid_t *sudoku_grid = (sudoku_grid_t *)malloc(sizeof(sudoku_grid_t));
     if (NULL == sudoku_grid)
     {
@@ -268,6 +481,8 @@ static sudoku_grid_t *CreateSudokuGrid()
     sudoku_grid->populated_cells_count = 0;
     sudoku_grid->current_col = 0;
     sudoku_grid->current_row = 0;
+    sudoku_grid->has_hint = 0;
+    sudoku_grid->journal = NULL;
 
     for (row = 0; row < sudoku_grid->board_size; ++row)
     {
@@ -277,6 +492,22 @@ static sudoku_grid_t *CreateSudokuGrid()
         }
     }
 
+    /* Classic rules unless the caller asks for a variant; the grid keeps its own copy */
+    sudoku_grid->variant = (NULL == variant) ? SudokuVariantCreate(VARIANT_CLASSIC) : SudokuVariantClone(variant);
+    if (NULL == sudoku_grid->variant)
+    {
+        fprintf(stderr, "Memory allocation failed.\r\n");
+        exit(EXIT_FAILURE);
+    }
+    SudokuVariantLoad(sudoku_grid->variant, empty_cells);
+
+    sudoku_grid->hint_engine = HintEngineCreate(sudoku_grid->variant);
+    if (NULL == sudoku_grid->hint_engine)
+    {
+        fprintf(stderr, "Memory allocation failed.\r\n");
+        exit(EXIT_FAILURE);
+    }
+
     return sudoku_grid;
 }
 
@@ -288,6 +519,9 @@ static void GetCoordinates(sudoku_grid_t *sudoku_grid, size_t *row, size_t *col)
 
 static void MoveCursor(sudoku_grid_t *sudoku_grid, int direction)
 {
+    unsigned int row = sudoku_grid->current_row;
+    unsigned int col = sudoku_grid->current_col;
+
     switch (direction)
     {
     case -1: /* Move up */
@@ -315,6 +549,11 @@ static void MoveCursor(sudoku_grid_t *sudoku_grid, int direction)
         }
         break;
     }
+
+    if ((row != sudoku_grid->current_row) || (col != sudoku_grid->current_col))
+    {
+        RecordCursor(sudoku_grid);
+    }
 }
 
 static void PrintSudokuGrid(sudoku_grid_t *sudoku_grid)
@@ -326,6 +565,7 @@ static void PrintSudokuGrid(sudoku_grid_t *sudoku_grid)
     size_t current_col = 0;
 
     unsigned int num = 0;
+    unsigned int candidates = 0;
 
     system("clear");
 
@@ -335,21 +575,38 @@ static void PrintSudokuGrid(sudoku_grid_t *sudoku_grid)
     {
         printf("You are initializing the board now...\r\n\n\n");
     }
+    if (!SudokuVariantIsClassic(sudoku_grid->variant))
+    {
+        printf("Rules: %s\r\n\n", SudokuVariantName(sudoku_grid->variant));
+    }
     printf("Enter the Sudoku grid numbers 1-9 (0 for empty cells):\r\n\n");
 
     printf("Possible values: ");
 
+    candidates = HintEngineGetCandidates(sudoku_grid->hint_engine, current_row, current_col);
     for (num = 1; num <= sudoku_grid->board_size; ++num)
     {
-        if (0 == sudoku_grid->board[current_row][current_col])
+        if (candidates & (1 << (num - 1)))
         {
-            if (IsLegalValue(sudoku_grid, num, current_row, current_col))
-            {
-                printf("%d ", num);
-            }
+            printf("%d ", num);
+        }
+    }
+    printf("\r\n");
+
+    if (sudoku_grid->has_hint)
+    {
+        if (HINT_CONTRADICTION == sudoku_grid->hint.technique)
+        {
+            printf("Hint: row %u, column %u has %s.\r\n", sudoku_grid->hint.row + 1, sudoku_grid->hint.col + 1,
+                   HintTechniqueName(sudoku_grid->hint.technique));
+        }
+        else
+        {
+            printf("Hint: row %u, column %u is %u (%s).\r\n", sudoku_grid->hint.row + 1, sudoku_grid->hint.col + 1,
+                   sudoku_grid->hint.digit, HintTechniqueName(sudoku_grid->hint.technique));
         }
     }
-    printf("\r\n\r\n");
+    printf("\r\n");
 
     for (row = 0; row < sudoku_grid->board_size; ++row)
     {
@@ -399,101 +656,25 @@ static void PrintSudokuGrid(sudoku_grid_t *sudoku_grid)
     else
     {
         printf("\n\n\nPress \"s\" to to get the solved sudoku grid.\r\n");
+        printf("Press \"h\" to get a hint for the next move.\r\n");
         printf("Press \"q\" to quit the game.\r\n");
     }
 }
 
-static void GetBoxCenter(size_t row, size_t col, size_t *row_center, size_t *col_center)
-{
-    *row_center = ((row / 3) * 3) + 1;
-    *col_center = ((col / 3) * 3) + 1;
-}
-
-static int IsNumberInBox(sudoku_grid_t *sudoku_grid, unsigned int number, size_t row_center, size_t col_center)
-{
-    if (number == sudoku_grid->board[row_center - 1][col_center - 1])
-    {
-        return 1;
-    }
-    if (number == sudoku_grid->board[row_center - 1][col_center])
-    {
-        return 1;
-    }
-    if (number == sudoku_grid->board[row_center - 1][col_center + 1])
-    {
-        return 1;
-    }
-    if (number == sudoku_grid->board[row_center][col_center - 1])
-    {
-        return 1;
-    }
-    if (number == sudoku_grid->board[row_center][col_center])
-    {
-        return 1;
-    }
-    if (number == sudoku_grid->board[row_center][col_center + 1])
-    {
-        return 1;
-    }
-    if (number == sudoku_grid->board[row_center + 1][col_center - 1])
-    {
-        return 1;
-    }
-    if (number == sudoku_grid->board[row_center + 1][col_center])
-    {
-        return 1;
-    }
-    if (number == sudoku_grid->board[row_center + 1][col_center + 1])
-    {
-        return 1;
-    }
-
-    return 0;
-}
-
-static int IsNumberInRowLine(sudoku_grid_t *sudoku_grid, unsigned int number, size_t row)
-{
-    size_t col = 0;
-
-    for (col = 0; col < sudoku_grid->board_size; ++col)
-    {
-        if (number == sudoku_grid->board[col][row])
-        {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-
-static int IsNumberInColLine(sudoku_grid_t *sudoku_grid, unsigned int number, size_t col)
+static int IsLegalValue(sudoku_grid_t *sudoku_grid, unsigned int number, size_t row, size_t col)
 {
-    size_t row = 0;
-
-    for (row = 0; row < sudoku_grid->board_size; ++row)
-    {
-        if (number == sudoku_grid->board[col][row])
-        {
-            return 1;
-        }
-    }
-
-    return 0;
+    return SudokuVariantIsLegal(sudoku_grid->variant, row * SUDOKU_DIMENSION + col, number);
 }
 
-static int IsLegalValue(sudoku_grid_t *sudoku_grid, unsigned int number, size_t row, size_t col)
+static void SetCellValue(sudoku_grid_t *sudoku_grid, size_t row, size_t col, unsigned int number)
 {
-    size_t row_center = 0;
-    size_t col_center = 0;
-
-    GetBoxCenter(row, col, &row_center, &col_center);
+    size_t cell = row * SUDOKU_DIMENSION + col;
 
-    if ((!IsNumberInBox(sudoku_grid, number, row_center, col_center)) && (!IsNumberInRowLine(sudoku_grid, number, col)) && (!IsNumberInColLine(sudoku_grid, number, row)))
-    {
-        return 1;
-    }
+    /* The variant keeps the unit masks of the board, so every write goes through here */
+    SudokuVariantClearCell(sudoku_grid->variant, cell);
+    SudokuVariantSetCell(sudoku_grid->variant, cell, number);
 
-    return 0;
+    sudoku_grid->board[row][col] = number;
 }
 
 static void RemoveNumber(sudoku_grid_t *sudoku_grid)
@@ -504,8 +685,15 @@ static void RemoveNumber(sudoku_grid_t *sudoku_grid)
 
     if ((0 != sudoku_grid->board[row][col]) && (0 == mask[row][col]))
     {
-        sudoku_grid->board[row][col] = 0;
+        SetCellValue(sudoku_grid, row, col, 0);
         --sudoku_grid->populated_cells_count;
+
+        HintEngineClearCell(sudoku_grid->hint_engine, row, col);
+
+        if (NULL != sudoku_grid->journal)
+        {
+            SudokuJournalClearCell(sudoku_grid->journal, row * SUDOKU_DIMENSION + col);
+        }
     }
 }
 
@@ -517,8 +705,15 @@ static void AddNumber(sudoku_grid_t *sudoku_grid, unsigned int number)
 
     if ((0 == sudoku_grid->board[row][col]) && (IsLegalValue(sudoku_grid, number, row, col)))
     {
-        sudoku_grid->board[row][col] = number;
+        SetCellValue(sudoku_grid, row, col, number);
         ++sudoku_grid->populated_cells_count;
+
+        HintEngineSetCell(sudoku_grid->hint_engine, row, col, number);
+
+        if (NULL != sudoku_grid->journal)
+        {
+            SudokuJournalSetCell(sudoku_grid->journal, row * SUDOKU_DIMENSION + col, number);
+        }
     }
 }
 
@@ -546,7 +741,7 @@ static void InitializeSudokuGrid(sudoku_grid_t *sudoku_grid, int difficulty_leve
             {
                 mask[row][col] = 0;
                 solved_board[row][col] = 0;
-                sudoku_grid->board[row][col] = 0;
+                SetCellValue(sudoku_grid, row, col, 0);
             }
         }
 
@@ -564,87 +759,331 @@ static void InitializeSudokuGrid(sudoku_grid_t *sudoku_grid, int difficulty_leve
                 {
                     mask[row][col] = 1;
                     solved_board[row][col] = number;
-                    sudoku_grid->board[row][col] = number;
+                    SetCellValue(sudoku_grid, row, col, number);
 
                     ++sudoku_grid->populated_cells_count;
                 }
             }
         }
 
-        /* Check if the generated board has a solution */
-        if ((AllCellsHavePossibleValues(sudoku_grid)) && (SolveSudoku(sudoku_grid, 0, 0)))
+        /* Check if the generated board has a solution, most attempts fail so keep them out of the cache */
+        if ((AllCellsHavePossibleValues(sudoku_grid)) && (0 != FindSolution(sudoku_grid, PLAIN_BACKTRACKING, 0)))
         {
             break;
         }
     }
+
+    ReloadHintEngine(sudoku_grid);
 }
 
-static int InitializeSudokuGridByUser(sudoku_grid_t *sudoku_grid)
+static int InitializeSudokuGridFromArchive(sudoku_grid_t *sudoku_grid, int difficulty_level)
 {
     size_t row = 0;
     size_t col = 0;
 
-    int flage = 0;
-    int input = 0;
-    int digit;
-    int solved = 0;
+    size_t block_count = 0;
+    size_t block_index = 0;
+    size_t tries = 0;
+    size_t count = 0;
+    size_t matches = 0;
+    size_t chosen = 0;
+    size_t i = 0;
+    size_t cell = 0;
+
+    unsigned int clues = 0;
+    unsigned int min_clues = (EXTREME == difficulty_level) ? 0 : GetPopulatedCellsCount(difficulty_level);
+    unsigned int max_clues = (EASY == difficulty_level) ? SUDOKU_CELLS : GetPopulatedCellsCount(difficulty_level - 1) - 1;
+
+    sudoku_archive_block_t block = {NULL, 0, 0, 0};
+    sudoku_archive_reader_t *reader = NULL;
+    unsigned char *puzzles = NULL;
+
+    reader = SudokuArchiveOpen(PUZZLE_ARCHIVE_FILE);
+    if (NULL == reader)
+    {
+        return 1;
+    }
 
-    /* Reset the board and counters */
-    sudoku_grid->populated_cells_count = 0;
-    sudoku_grid->current_row = 0;
-    sudoku_grid->current_col = 0;
+    puzzles = (unsigned char *)malloc((size_t)SUDOKU_ARCHIVE_BLOCK_PUZZLES * SUDOKU_CELLS);
+    if (NULL == puzzles)
+    {
+        SudokuArchiveCloseReader(reader);
+        return 1;
+    }
 
-    for (row = 0; row < sudoku_grid->board_size; ++row)
+    while (1 == SudokuArchiveSkipBlock(reader))
     {
-        for (col = 0; col < sudoku_grid->board_size; ++col)
-        {
-            mask[row][col] = 0;
-            solved_board[row][col] = 0;
-            sudoku_grid->board[row][col] = 0;
-        }
+        ++block_count;
     }
 
-    row = 0;
-    col = 0;
-    print_location = INITIATE_FROM_INITIALIZATION;
+    /* Start at a random block and take a random puzzle of the right level from the first block that has one */
+    block_index = (0 != block_count) ? ((size_t)rand() % block_count) : 0;
 
-    while (1)
+    SudokuArchiveRewind(reader);
+    for (i = 0; i < block_index; ++i)
     {
-        while ('r' != (input = getch()))
+        SudokuArchiveSkipBlock(reader);
+    }
+
+    /* Read on from there, wrapping around to the first block once */
+    for (tries = 0; (tries < block_count) && (0 == matches); ++tries)
+    {
+        if (block_index + tries == block_count)
         {
-            if (!flage)
+            SudokuArchiveRewind(reader);
+        }
+
+        if (1 != SudokuArchiveNextBlock(reader, &block))
+        {
+            break;
+        }
+
+        count = SudokuArchiveDecodeBlock(&block, puzzles, SUDOKU_ARCHIVE_BLOCK_PUZZLES);
+        for (i = 0; i < count; ++i)
+        {
+            clues = 0;
+            for (cell = 0; cell < SUDOKU_CELLS; ++cell)
             {
-                PrintSudokuGrid(sudoku_grid);
-                flage = 1;
+                clues += (0 != puzzles[i * SUDOKU_CELLS + cell]);
             }
 
-            if (-1 == input)
+            if ((min_clues <= clues) && (clues <= max_clues) && (0 == (size_t)rand() % ++matches))
             {
-                continue;
+                chosen = i;
             }
+        }
+    }
 
-            switch (input)
+    SudokuArchiveFreeBlock(&block);
+    SudokuArchiveCloseReader(reader);
+
+    if (0 != matches)
+    {
+        sudoku_grid->populated_cells_count = 0;
+        sudoku_grid->current_row = 0;
+        sudoku_grid->current_col = 0;
+
+        for (row = 0; row < sudoku_grid->board_size; ++row)
+        {
+            for (col = 0; col < sudoku_grid->board_size; ++col)
             {
-            case KEY_UP:
-                MoveCursor(sudoku_grid, -1); /* Move up */
-                break;
-            case KEY_DOWN:
-                MoveCursor(sudoku_grid, 1); /* Move down */
-                break;
-            case KEY_LEFT:
-                MoveCursor(sudoku_grid, -2); /* Move left */
-                break;
-            case KEY_RIGHT:
-                MoveCursor(sudoku_grid, 2); /* Move right */
-                break;
-            case '0': /* Allow the user to input '0' to clear a cell */
-                GetCoordinates(sudoku_grid, &row, &col);
+                SetCellValue(sudoku_grid, row, col, puzzles[chosen * SUDOKU_CELLS + row * SUDOKU_DIMENSION + col]);
+                solved_board[row][col] = sudoku_grid->board[row][col];
+                mask[row][col] = (0 != sudoku_grid->board[row][col]);
+                sudoku_grid->populated_cells_count += mask[row][col];
+            }
+        }
 
-                mask[row][col] = 0;
-                solved_board[row][col] = 0;
-                sudoku_grid->board[row][col] = 0;
+        /* Archived puzzles can be hard, so let the learning solver find the solution */
+        if (0 == FindSolution(sudoku_grid, NOGOOD_LEARNING, 1))
+        {
+            matches = 0;
+        }
+    }
 
-                --sudoku_grid->populated_cells_count;
+    free(puzzles);
+
+    if (0 == matches)
+    {
+        return 1;
+    }
+
+    ReloadHintEngine(sudoku_grid);
+
+    return 0;
+}
+
+static void InitializeVariantSudokuGrid(sudoku_grid_t *sudoku_grid, int difficulty_level)
+{
+    size_t row = 0;
+    size_t col = 0;
+
+    unsigned long budget = 0;
+
+    /* Random clues rarely fit the extra units, so fill a whole grid first and keep some of it */
+    do
+    {
+        for (row = 0; row < sudoku_grid->board_size; ++row)
+        {
+            for (col = 0; col < sudoku_grid->board_size; ++col)
+            {
+                SetCellValue(sudoku_grid, row, col, 0);
+            }
+        }
+
+        budget = VARIANT_FILL_BUDGET;
+    } while (!FillRandomGrid(sudoku_grid, &budget));
+
+    sudoku_grid->populated_cells_count = 0;
+    sudoku_grid->current_row = 0;
+    sudoku_grid->current_col = 0;
+
+    for (row = 0; row < sudoku_grid->board_size; ++row)
+    {
+        for (col = 0; col < sudoku_grid->board_size; ++col)
+        {
+            mask[row][col] = 0;
+            solved_board[row][col] = sudoku_grid->board[row][col];
+            SetCellValue(sudoku_grid, row, col, 0);
+        }
+    }
+
+    while (sudoku_grid->populated_cells_count < GetPopulatedCellsCount(difficulty_level))
+    {
+        col = (rand() % SUDOKU_DIMENSION);
+        row = (rand() % SUDOKU_DIMENSION);
+
+        if (0 == mask[row][col])
+        {
+            mask[row][col] = 1;
+            SetCellValue(sudoku_grid, row, col, solved_board[row][col]);
+            ++sudoku_grid->populated_cells_count;
+        }
+    }
+
+    ReloadHintEngine(sudoku_grid);
+}
+
+static int FillRandomGrid(sudoku_grid_t *sudoku_grid, unsigned long *budget)
+{
+    size_t cell = 0;
+    size_t best_cell = SUDOKU_CELLS;
+    size_t count = 0;
+    size_t best_count = SUDOKU_DIMENSION + 1;
+    size_t i = 0;
+    size_t j = 0;
+
+    unsigned int candidates = 0;
+    unsigned int digits[SUDOKU_DIMENSION];
+    unsigned int swap = 0;
+
+    /* Fill the cell with the fewest candidates next, trying its digits in random order */
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (0 != sudoku_grid->board[cell / SUDOKU_DIMENSION][cell % SUDOKU_DIMENSION])
+        {
+            continue;
+        }
+
+        candidates = SudokuVariantCandidates(sudoku_grid->variant, cell);
+        for (count = 0; 0 != candidates; ++count)
+        {
+            candidates &= candidates - 1;
+        }
+
+        if (count < best_count)
+        {
+            best_cell = cell;
+            best_count = count;
+        }
+    }
+
+    if (SUDOKU_CELLS == best_cell)
+    {
+        return 1;
+    }
+
+    candidates = SudokuVariantCandidates(sudoku_grid->variant, best_cell);
+    for (count = 0, i = 1; i <= SUDOKU_DIMENSION; ++i)
+    {
+        if (candidates & (1 << (i - 1)))
+        {
+            digits[count++] = (unsigned int)i;
+        }
+    }
+
+    for (i = count; 1 < i; --i)
+    {
+        j = (size_t)rand() % i;
+        swap = digits[i - 1];
+        digits[i - 1] = digits[j];
+        digits[j] = swap;
+    }
+
+    for (i = 0; (i < count) && (0 != *budget); ++i)
+    {
+        --*budget;
+        SetCellValue(sudoku_grid, best_cell / SUDOKU_DIMENSION, best_cell % SUDOKU_DIMENSION, digits[i]);
+
+        if (FillRandomGrid(sudoku_grid, budget))
+        {
+            return 1;
+        }
+
+        SetCellValue(sudoku_grid, best_cell / SUDOKU_DIMENSION, best_cell % SUDOKU_DIMENSION, 0);
+    }
+
+    return 0;
+}
+
+static int InitializeSudokuGridByUser(sudoku_grid_t *sudoku_grid)
+{
+    size_t row = 0;
+    size_t col = 0;
+
+    int flage = 0;
+    int input = 0;
+    int digit;
+    int solved = 0;
+
+    /* Reset the board and counters */
+    sudoku_grid->populated_cells_count = 0;
+    sudoku_grid->current_row = 0;
+    sudoku_grid->current_col = 0;
+
+    for (row = 0; row < sudoku_grid->board_size; ++row)
+    {
+        for (col = 0; col < sudoku_grid->board_size; ++col)
+        {
+            mask[row][col] = 0;
+            solved_board[row][col] = 0;
+            SetCellValue(sudoku_grid, row, col, 0);
+        }
+    }
+
+    row = 0;
+    col = 0;
+    print_location = INITIATE_FROM_INITIALIZATION;
+
+    while (1)
+    {
+        while ('r' != (input = getch()))
+        {
+            if (!flage)
+            {
+                PrintSudokuGrid(sudoku_grid);
+                flage = 1;
+            }
+
+            if (-1 == input)
+            {
+                continue;
+            }
+
+            switch (input)
+            {
+            case KEY_UP:
+                MoveCursor(sudoku_grid, -1); /* Move up */
+                break;
+            case KEY_DOWN:
+                MoveCursor(sudoku_grid, 1); /* Move down */
+                break;
+            case KEY_LEFT:
+                MoveCursor(sudoku_grid, -2); /* Move left */
+                break;
+            case KEY_RIGHT:
+                MoveCursor(sudoku_grid, 2); /* Move right */
+                break;
+            case '0': /* Allow the user to input '0' to clear a cell */
+                GetCoordinates(sudoku_grid, &row, &col);
+
+                mask[row][col] = 0;
+                solved_board[row][col] = 0;
+                SetCellValue(sudoku_grid, row, col, 0);
+
+                --sudoku_grid->populated_cells_count;
+
+                HintEngineClearCell(sudoku_grid->hint_engine, row, col);
 
                 break;
             default:
@@ -667,8 +1106,8 @@ static int InitializeSudokuGridByUser(sudoku_grid_t *sudoku_grid)
             /* Update the display or perform other tasks as needed */
             PrintSudokuGrid(sudoku_grid);
         }
-        /* Check if the generated board has a solution */
-        solved = SolveSudoku(sudoku_grid, 0, 0);
+        /* Check if the generated board has a solution, user boards can be adversarial */
+        solved = (0 != FindSolution(sudoku_grid, NOGOOD_LEARNING, 1));
 
         system("clear");
         printf("LOADING ...\n");
@@ -691,57 +1130,366 @@ static int InitializeSudokuGridByUser(sudoku_grid_t *sudoku_grid)
 
 static void DestroySudokuGrid(sudoku_grid_t *sudoku_grid)
 {
+    if (NULL != sudoku_grid->journal)
+    {
+        SudokuJournalClose(sudoku_grid->journal);
+    }
+    HintEngineDestroy(sudoku_grid->hint_engine);
+    SudokuVariantDestroy(sudoku_grid->variant);
     free(sudoku_grid);
     sudoku_grid = NULL;
 }
 
-static int SolveSudoku(sudoku_grid_t *sudoku_grid, size_t row, size_t col)
+static void CountSolutions(sudoku_grid_t *sudoku_grid, size_t row, size_t col, unsigned int *solution_count, unsigned int limit)
 {
     unsigned int num = 1;
+    unsigned int candidates = 0;
 
     if (row == sudoku_grid->board_size)
     {
         row = 0;
         if (++col == sudoku_grid->board_size)
         {
-            return 1; /* Entire board is filled, a solution is found */
+            /* Entire board is filled, keep the first solution found */
+            if (0 == *solution_count)
+            {
+                StoreSolution(sudoku_grid);
+            }
+
+            ++*solution_count;
+            return;
         }
     }
 
     if (0 == sudoku_grid->board[row][col])
     {
-        for (num = 1; num <= sudoku_grid->board_size; ++num)
+        candidates = SudokuVariantCandidates(sudoku_grid->variant, row * SUDOKU_DIMENSION + col);
+
+        for (num = 1; (num <= sudoku_grid->board_size) && (*solution_count < limit); ++num)
         {
-            if (IsLegalValue(sudoku_grid, num, row, col))
+            if (candidates & (1 << (num - 1)))
             {
-                sudoku_grid->board[row][col] = num;
-                solved_board[row][col] = num;
+                SetCellValue(sudoku_grid, row, col, num);
+                ++solver_stats.nodes;
 
-                if (SolveSudoku(sudoku_grid, row + 1, col))
-                {
-                    sudoku_grid->board[row][col] = 0;
-                    return 1; /* If a solution is found, return 1 */
-                }
+                CountSolutions(sudoku_grid, row + 1, col, solution_count, limit);
+                SetCellValue(sudoku_grid, row, col, 0); /* Backtrack */
+            }
+        }
 
-                sudoku_grid->board[row][col] = 0; /* If no solution, backtrack */
-                solved_board[row][col] = 0;
+        return;
+    }
+
+    CountSolutions(sudoku_grid, row + 1, col, solution_count, limit); /* Move to the next row */
+}
+
+static unsigned int FindSolution(sudoku_grid_t *sudoku_grid, enum solver_mode mode, int use_cache)
+{
+    size_t row = 0;
+    size_t col = 0;
+
+    unsigned char puzzle[SUDOKU_CELLS];
+    unsigned char solution[SUDOKU_CELLS];
+    unsigned int solution_count = 0;
+
+    learning_state_t *state = NULL;
+    conflict_set_t conflict = {{0, 0}};
+
+    /* Cache keys are the digits alone, which only pin down the solution under classic rules */
+    sudoku_cache_t *cache = ((use_cache) && (SudokuVariantIsClassic(sudoku_grid->variant))) ? solution_cache : NULL;
+    unsigned int limit = (use_cache) ? 2 : 1; /* Callers that cache also report uniqueness; generation needs any one */
+
+    solver_stats.nodes = 0;
+    solver_stats.backjumps = 0;
+    solver_stats.nogoods_learned = 0;
+    solver_stats.nogood_prunes = 0;
+
+    for (row = 0; row < sudoku_grid->board_size; ++row)
+    {
+        for (col = 0; col < sudoku_grid->board_size; ++col)
+        {
+            puzzle[row * SUDOKU_DIMENSION + col] = (unsigned char)sudoku_grid->board[row][col];
+        }
+    }
+
+    /* A repeated puzzle is answered from the cache without searching */
+    if ((NULL != cache) && (SudokuCacheLookup(cache, puzzle, solution, &solution_count)))
+    {
+        for (row = 0; row < sudoku_grid->board_size; ++row)
+        {
+            for (col = 0; col < sudoku_grid->board_size; ++col)
+            {
+                solved_board[row][col] = solution[row * SUDOKU_DIMENSION + col];
             }
         }
 
-        return 0; /* If no valid number can be placed, trigger backtracking */
+        return solution_count;
     }
 
-    return SolveSudoku(sudoku_grid, row + 1, col); /* Move to the next row */
+    if (NOGOOD_LEARNING == mode)
+    {
+        state = (learning_state_t *)calloc(1, sizeof(learning_state_t));
+    }
+
+    if (NULL != state)
+    {
+        InitializeLearningState(sudoku_grid, state);
+        CountSolutionsLearning(sudoku_grid, state, 0, &solution_count, limit, &conflict);
+        free(state);
+    }
+    else
+    {
+        CountSolutions(sudoku_grid, 0, 0, &solution_count, limit);
+    }
+
+    if (NULL != cache)
+    {
+        for (row = 0; row < sudoku_grid->board_size; ++row)
+        {
+            for (col = 0; col < sudoku_grid->board_size; ++col)
+            {
+                solution[row * SUDOKU_DIMENSION + col] = (0 != solution_count) ? (unsigned char)solved_board[row][col]
+                                                                               : puzzle[row * SUDOKU_DIMENSION + col];
+            }
+        }
+
+        SudokuCacheInsert(cache, puzzle, solution, solution_count);
+    }
+
+    return solution_count;
 }
 
-static int HasPossibleValue(sudoku_grid_t *sudoku_grid, size_t row, size_t col)
+static int CountSolutionsLearning(sudoku_grid_t *sudoku_grid, learning_state_t *state, size_t depth,
+                                  unsigned int *solution_count, unsigned int limit, conflict_set_t *conflict)
 {
-    size_t num = 0;
+    size_t cell = 0;
+    size_t row = 0;
+    size_t col = 0;
 
-    for (num = 1; num <= sudoku_grid->board_size; ++num)
+    unsigned int num = 1;
+    int culprit = 0;
+    int found = 0;
+
+    conflict_set_t reasons = {{0, 0}};
+    conflict_set_t sub_conflict = {{0, 0}};
+
+    if (depth == state->empty_count)
+    {
+        /* Entire board is filled, keep the first solution found */
+        if (0 == *solution_count)
+        {
+            StoreSolution(sudoku_grid);
+        }
+
+        ++*solution_count;
+        return 1;
+    }
+
+    cell = state->order[depth];
+    row = cell / SUDOKU_DIMENSION;
+    col = cell % SUDOKU_DIMENSION;
+
+    for (num = 1; (num <= sudoku_grid->board_size) && (*solution_count < limit); ++num)
+    {
+        culprit = FindCulprit(sudoku_grid, state, cell, num);
+        if (-1 == culprit)
+        {
+            continue; /* Ruled out by a given, no decision to blame */
+        }
+        if (0 <= culprit)
+        {
+            reasons.cells[culprit / 64] |= 1ULL << (culprit % 64);
+            continue;
+        }
+        if ((state->has_cages) && (!IsLegalValue(sudoku_grid, num, row, col)))
+        {
+            AddCageReasons(sudoku_grid, state, cell, &reasons);
+            continue;
+        }
+
+        SetDecision(sudoku_grid, state, row, col, num);
+        ++solver_stats.nodes;
+
+        if (MatchNogood(sudoku_grid, state, cell, num, &reasons))
+        {
+            ++solver_stats.nogood_prunes;
+            SetDecision(sudoku_grid, state, row, col, 0);
+            continue;
+        }
+
+        sub_conflict.cells[0] = 0;
+        sub_conflict.cells[1] = 0;
+
+        if (CountSolutionsLearning(sudoku_grid, state, depth + 1, solution_count, limit, &sub_conflict))
+        {
+            found = 1;
+            SetDecision(sudoku_grid, state, row, col, 0);
+            continue;
+        }
+
+        SetDecision(sudoku_grid, state, row, col, 0); /* Backtrack */
+
+        /* The dead end below does not depend on this cell, so jump straight back over it */
+        if ((!found) && (0 == (sub_conflict.cells[cell / 64] & (1ULL << (cell % 64)))))
+        {
+            *conflict = sub_conflict;
+            ++solver_stats.backjumps;
+            return 0;
+        }
+
+        sub_conflict.cells[cell / 64] &= ~(1ULL << (cell % 64));
+        reasons.cells[0] |= sub_conflict.cells[0];
+        reasons.cells[1] |= sub_conflict.cells[1];
+    }
+
+    if (!found)
+    {
+        /* The digits of the reason cells together leave this cell without a value */
+        RecordNogood(sudoku_grid, state, &reasons);
+        *conflict = reasons;
+    }
+
+    return found;
+}
+
+static void InitializeLearningState(sudoku_grid_t *sudoku_grid, learning_state_t *state)
+{
+    size_t row = 0;
+    size_t col = 0;
+    size_t cell = 0;
+    size_t unit = 0;
+
+    /* Same cell order as CountSolutions, so node counts can be compared */
+    state->empty_count = 0;
+    for (col = 0; col < sudoku_grid->board_size; ++col)
+    {
+        for (row = 0; row < sudoku_grid->board_size; ++row)
+        {
+            cell = row * SUDOKU_DIMENSION + col;
+            state->depth_of[cell] = -1;
+
+            if (0 == sudoku_grid->board[row][col])
+            {
+                state->depth_of[cell] = (int)state->empty_count;
+                state->order[state->empty_count++] = cell;
+            }
+        }
+    }
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        state->peer_count[cell] = SudokuVariantPeers(sudoku_grid->variant, cell, &state->peers[cell]);
+    }
+
+    state->has_cages = 0;
+    for (unit = 0; unit < SudokuVariantUnitCount(sudoku_grid->variant); ++unit)
+    {
+        state->has_cages |= (UNIT_CAGE == SudokuVariantUnitKind(sudoku_grid->variant, unit));
+    }
+}
+
+static int FindCulprit(sudoku_grid_t *sudoku_grid, learning_state_t *state, size_t cell, unsigned int number)
+{
+    size_t i = 0;
+    size_t peer = 0;
+    int culprit = -2;
+
+    /* Blame the earliest decision holding the digit, or nothing if a given holds it */
+    for (i = 0; i < state->peer_count[cell]; ++i)
+    {
+        peer = state->peers[cell][i];
+
+        if (number == sudoku_grid->board[peer / SUDOKU_DIMENSION][peer % SUDOKU_DIMENSION])
+        {
+            if (0 > state->depth_of[peer])
+            {
+                return -1;
+            }
+            if ((0 > culprit) || (state->depth_of[peer] < state->depth_of[culprit]))
+            {
+                culprit = (int)peer;
+            }
+        }
+    }
+
+    return culprit;
+}
+
+static void AddCageReasons(sudoku_grid_t *sudoku_grid, learning_state_t *state, size_t cell, conflict_set_t *reasons)
+{
+    const unsigned char *units = NULL;
+    const unsigned char *members = NULL;
+    size_t unit_count = SudokuVariantCellUnits(sudoku_grid->variant, cell, &units);
+    size_t member_count = 0;
+    size_t member = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    /* The sum left depends on every digit in the cage, so blame all the decisions in it */
+    for (i = 0; i < unit_count; ++i)
     {
-        if (IsLegalValue(sudoku_grid, num, row, col))
+        if (UNIT_CAGE != SudokuVariantUnitKind(sudoku_grid->variant, units[i]))
+        {
+            continue;
+        }
+
+        member_count = SudokuVariantUnitCells(sudoku_grid->variant, units[i], &members);
+        for (j = 0; j < member_count; ++j)
         {
+            member = members[j];
+            if ((0 <= state->depth_of[member]) && (0 != sudoku_grid->board[member / SUDOKU_DIMENSION][member % SUDOKU_DIMENSION]))
+            {
+                reasons->cells[member / 64] |= 1ULL << (member % 64);
+            }
+        }
+    }
+}
+
+static void SetDecision(sudoku_grid_t *sudoku_grid, learning_state_t *state, size_t row, size_t col, unsigned int number)
+{
+    /* Peers are read off the board and every decision is undone, so only cage sums need the masks */
+    if (state->has_cages)
+    {
+        SetCellValue(sudoku_grid, row, col, number);
+    }
+    else
+    {
+        sudoku_grid->board[row][col] = number;
+    }
+}
+
+static int MatchNogood(sudoku_grid_t *sudoku_grid, learning_state_t *state, size_t cell, unsigned int number, conflict_set_t *conflict)
+{
+    size_t way = 0;
+    size_t i = 0;
+    size_t literal_cell = 0;
+    nogood_t *nogood = NULL;
+
+    for (way = 0; way < NOGOOD_WAYS; ++way)
+    {
+        nogood = &state->nogoods[cell * SUDOKU_DIMENSION + number - 1][way];
+        if (!nogood->used)
+        {
+            continue;
+        }
+
+        for (i = 0; i < nogood->size; ++i)
+        {
+            literal_cell = nogood->literals[i] / SUDOKU_DIMENSION;
+            if ((unsigned int)(nogood->literals[i] % SUDOKU_DIMENSION + 1) !=
+                sudoku_grid->board[literal_cell / SUDOKU_DIMENSION][literal_cell % SUDOKU_DIMENSION])
+            {
+                break;
+            }
+        }
+
+        if (i == nogood->size)
+        {
+            for (i = 0; i < nogood->size; ++i)
+            {
+                literal_cell = nogood->literals[i] / SUDOKU_DIMENSION;
+                conflict->cells[literal_cell / 64] |= 1ULL << (literal_cell % 64);
+            }
             return 1;
         }
     }
@@ -749,6 +1497,101 @@ static int HasPossibleValue(sudoku_grid_t *sudoku_grid, size_t row, size_t col)
     return 0;
 }
 
+static void RecordNogood(sudoku_grid_t *sudoku_grid, learning_state_t *state, const conflict_set_t *conflict)
+{
+    unsigned short literals[NOGOOD_MAX_LITERALS + 1];
+    size_t size = 0;
+    size_t cell = 0;
+    size_t trigger = 0;
+    size_t way = 0;
+    size_t slot = 0;
+    size_t i = 0;
+    nogood_t *nogood = NULL;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (conflict->cells[cell / 64] & (1ULL << (cell % 64)))
+        {
+            if (NOGOOD_MAX_LITERALS + 1 == size)
+            {
+                return; /* Large nogoods rarely prune anything, keep the store small */
+            }
+
+            literals[size] = (unsigned short)(cell * SUDOKU_DIMENSION +
+                                              sudoku_grid->board[cell / SUDOKU_DIMENSION][cell % SUDOKU_DIMENSION] - 1);
+
+            /* The deepest decision is the one that completes the nogood */
+            if ((0 == size) || (state->depth_of[cell] > state->depth_of[literals[trigger] / SUDOKU_DIMENSION]))
+            {
+                trigger = size;
+            }
+            ++size;
+        }
+    }
+
+    if (0 == size)
+    {
+        return;
+    }
+
+    slot = literals[trigger];
+    literals[trigger] = literals[--size];
+
+    way = state->next_way[slot];
+    state->next_way[slot] = (unsigned char)((way + 1) % NOGOOD_WAYS);
+
+    nogood = &state->nogoods[slot][way];
+    for (i = 0; i < size; ++i)
+    {
+        nogood->literals[i] = literals[i];
+    }
+    nogood->size = (unsigned char)size;
+    nogood->used = 1;
+
+    ++solver_stats.nogoods_learned;
+}
+
+static void StoreSolution(sudoku_grid_t *sudoku_grid)
+{
+    size_t row = 0;
+    size_t col = 0;
+
+    for (row = 0; row < sudoku_grid->board_size; ++row)
+    {
+        for (col = 0; col < sudoku_grid->board_size; ++col)
+        {
+            solved_board[row][col] = sudoku_grid->board[row][col];
+        }
+    }
+}
+
+static int OpenSolutionCache()
+{
+    /* A cache shared through SetSolutionCache belongs to the caller */
+    if (NULL != solution_cache)
+    {
+        return 0;
+    }
+
+    solution_cache = SudokuCacheCreate(SOLUTION_CACHE_CAPACITY, SOLUTION_CACHE_FILE);
+
+    return (NULL != solution_cache);
+}
+
+static void CloseSolutionCache(int owns_cache)
+{
+    if (owns_cache)
+    {
+        SudokuCacheDestroy(solution_cache);
+        solution_cache = NULL;
+    }
+}
+
+static int HasPossibleValue(sudoku_grid_t *sudoku_grid, size_t row, size_t col)
+{
+    return (0 != SudokuVariantCandidates(sudoku_grid->variant, row * SUDOKU_DIMENSION + col));
+}
+
 static int AllCellsHavePossibleValues(sudoku_grid_t *sudoku_grid)
 {
     size_t row = 0;
@@ -787,3 +1630,136 @@ static unsigned int GetPopulatedCellsCount(int difficulty_level)
         exit(EXIT_FAILURE);
     }
 }
+
+static void ReloadHintEngine(sudoku_grid_t *sudoku_grid)
+{
+    size_t row = 0;
+    size_t col = 0;
+
+    unsigned char cells[SUDOKU_CELLS];
+
+    for (row = 0; row < sudoku_grid->board_size; ++row)
+    {
+        for (col = 0; col < sudoku_grid->board_size; ++col)
+        {
+            cells[row * SUDOKU_DIMENSION + col] = (unsigned char)sudoku_grid->board[row][col];
+        }
+    }
+
+    HintEngineLoad(sudoku_grid->hint_engine, cells);
+}
+
+static void ShowHint(sudoku_grid_t *sudoku_grid)
+{
+    size_t row = 0;
+    size_t col = 0;
+
+    sudoku_grid->has_hint = HintEngineNext(sudoku_grid->hint_engine, &sudoku_grid->hint);
+
+    /* No deduction applies, fall back to the first empty cell of the solution that still fits */
+    for (row = 0; (row < sudoku_grid->board_size) && (!sudoku_grid->has_hint); ++row)
+    {
+        for (col = 0; (col < sudoku_grid->board_size) && (!sudoku_grid->has_hint); ++col)
+        {
+            if ((0 == sudoku_grid->board[row][col]) && (0 != solved_board[row][col]) &&
+                (IsLegalValue(sudoku_grid, solved_board[row][col], row, col)))
+            {
+                sudoku_grid->hint.row = row;
+                sudoku_grid->hint.col = col;
+                sudoku_grid->hint.digit = solved_board[row][col];
+                sudoku_grid->hint.technique = HINT_SOLUTION;
+                sudoku_grid->has_hint = 1;
+            }
+        }
+    }
+
+    if (sudoku_grid->has_hint)
+    {
+        /* Move the cursor to the cell the hint is about */
+        sudoku_grid->current_row = sudoku_grid->hint.row;
+        sudoku_grid->current_col = sudoku_grid->hint.col;
+        RecordCursor(sudoku_grid);
+    }
+}
+
+static void StartSessionJournal(sudoku_grid_t *sudoku_grid, unsigned int rules)
+{
+    sudoku_journal_state_t state;
+
+    size_t row = 0;
+    size_t col = 0;
+    size_t cell = 0;
+
+    state.rules = rules;
+    state.cursor = sudoku_grid->current_row * SUDOKU_DIMENSION + sudoku_grid->current_col;
+
+    for (row = 0; row < sudoku_grid->board_size; ++row)
+    {
+        for (col = 0; col < sudoku_grid->board_size; ++col)
+        {
+            cell = row * SUDOKU_DIMENSION + col;
+            state.board[cell] = (unsigned char)sudoku_grid->board[row][col];
+            state.givens[cell] = mask[row][col] ? state.board[cell] : 0;
+            state.solution[cell] = (unsigned char)solved_board[row][col];
+        }
+    }
+
+    /* The game goes on without a journal if the file cannot be written */
+    sudoku_grid->journal = SudokuJournalCreate(SESSION_JOURNAL_FILE, &state);
+}
+
+static sudoku_grid_t *ResumeSudokuGame()
+{
+    sudoku_journal_state_t state;
+    sudoku_journal_t *journal = NULL;
+    sudoku_variant_t *variant = NULL;
+    sudoku_grid_t *sudoku_grid = NULL;
+
+    size_t row = 0;
+    size_t col = 0;
+    size_t cell = 0;
+
+    /* Reads the latest snapshot and the moves after it, not the whole session */
+    journal = SudokuJournalResume(SESSION_JOURNAL_FILE, &state);
+    if (NULL == journal)
+    {
+        return NULL;
+    }
+
+    variant = SudokuVariantCreate(state.rules);
+    if (NULL == variant)
+    {
+        fprintf(stderr, "Memory allocation failed.\r\n");
+        exit(EXIT_FAILURE);
+    }
+    sudoku_grid = CreateSudokuGrid(variant);
+    SudokuVariantDestroy(variant);
+
+    for (row = 0; row < sudoku_grid->board_size; ++row)
+    {
+        for (col = 0; col < sudoku_grid->board_size; ++col)
+        {
+            cell = row * SUDOKU_DIMENSION + col;
+            SetCellValue(sudoku_grid, row, col, state.board[cell]);
+            solved_board[row][col] = state.solution[cell];
+            mask[row][col] = (0 != state.givens[cell]);
+            sudoku_grid->populated_cells_count += (0 != state.board[cell]);
+        }
+    }
+
+    sudoku_grid->current_row = state.cursor / SUDOKU_DIMENSION;
+    sudoku_grid->current_col = state.cursor % SUDOKU_DIMENSION;
+    sudoku_grid->journal = journal;
+    ReloadHintEngine(sudoku_grid);
+
+    return sudoku_grid;
+}
+
+static void RecordCursor(sudoku_grid_t *sudoku_grid)
+{
+    if (NULL != sudoku_grid->journal)
+    {
+        SudokuJournalMoveCursor(sudoku_grid->journal,
+                                sudoku_grid->current_row * SUDOKU_DIMENSION + sudoku_grid->current_col);
+    }
+}
@@ -13,6 +13,16 @@
 #ifndef SUDOKU_H
 #define SUDOKU_H
 
+#include "sudoku_cache.h"
+#include "sudoku_variant.h"
+
+/**
+ * @def SUDOKU_CELLS
+ * Number of cells in a puzzle passed through the headless API.
+ * Cells are stored row by row, with 0 for empty cells.
+ */
+#define SUDOKU_CELLS 81
+
 /**
  * @enum level
  * Enumeration for difficulty levels in Sudoku.
@@ -27,6 +37,32 @@ enum level
     EXTREME = 5
 };
 
+/**
+ * @enum solver_mode
+ * Enumeration for the search used to solve a board.
+ * PLAIN_BACKTRACKING tries every digit in every empty cell in order.
+ * NOGOOD_LEARNING also jumps back to the cause of a dead end and
+ * remembers small sets of conflicting digits (nogoods) so any later
+ * branch that contains one is pruned at once.
+ */
+enum solver_mode
+{
+    PLAIN_BACKTRACKING = 1,
+    NOGOOD_LEARNING = 2
+};
+
+/**
+ * @struct Solver_Stats
+ * Counters describing the work done by the last solve.
+ */
+typedef struct Solver_Stats
+{
+    unsigned long nodes;           /* Digits placed during the search */
+    unsigned long backjumps;       /* Levels skipped by jumping back to a conflict */
+    unsigned long nogoods_learned; /* Nogoods added to the store */
+    unsigned long nogood_prunes;   /* Branches cut by a known nogood */
+} solver_stats_t;
+
 /**
  * @typedef sudoku_grid_t
  * Typedef for the Sudoku grid structure.
@@ -52,4 +88,53 @@ void InitiateSudokuGame();
  */
 int SolveSudokuGrid();
 
+/**
+ * @brief Solve a puzzle without the interactive interface.
+ *
+ * The solution cache set by SetSolutionCache is consulted first and
+ * updated after a miss. This function uses the game's global boards,
+ * so it must not be called from several threads at once.
+ *
+ * @param puzzle 81 cells in row-major order, 0 for empty cells.
+ * @param solution Receives the first solution found (may be NULL).
+ * @return Number of solutions found, capped at 2 (0 = no solution).
+ */
+unsigned int SolveSudokuPuzzle(const unsigned char *puzzle, unsigned char *solution);
+
+/**
+ * @brief Solve a puzzle with a chosen search and report its work.
+ *
+ * Same as SolveSudokuPuzzle, which uses NOGOOD_LEARNING. A puzzle
+ * answered from the solution cache reports no nodes.
+ *
+ * @param mode The search to use.
+ * @param stats Receives the counters of the solve (may be NULL).
+ * @return Number of solutions found, capped at 2 (0 = no solution).
+ */
+unsigned int SolveSudokuPuzzleWithMode(const unsigned char *puzzle, unsigned char *solution,
+                                       enum solver_mode mode, solver_stats_t *stats);
+
+/**
+ * @brief Solve a puzzle under the rules of a variant.
+ *
+ * Same as SolveSudokuPuzzleWithMode, with diagonal, windoku, jigsaw or
+ * killer rules. The solution cache is only used for classic rules.
+ *
+ * @param variant The rules to solve under, or NULL for classic Sudoku.
+ *                Its board is not used.
+ * @return Number of solutions found, capped at 2 (0 = no solution).
+ */
+unsigned int SolveSudokuVariantPuzzle(const sudoku_variant_t *variant, const unsigned char *puzzle,
+                                      unsigned char *solution, enum solver_mode mode, solver_stats_t *stats);
+
+/**
+ * @brief Share a solution cache with the game and the headless API.
+ *
+ * When no cache is set, the interactive game opens its own cache
+ * backed by a file in the working directory for its duration.
+ *
+ * @param cache The cache to use, or NULL to stop using one.
+ */
+void SetSolutionCache(sudoku_cache_t *cache);
+
 #endif /* SUDOKU_H */
@@ -0,0 +1,757 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#include <stdio.h>   /* FILE, fopen, fread, fwrite, fseek, fclose */
+#include <stdlib.h>  /* malloc, calloc, realloc, free */
+#include <string.h>  /* memcmp, memcpy */
+#include <stdint.h>  /* uint32_t, uint64_t */
+#include <pthread.h> /* pthread_mutex_t, pthread_mutex_lock, pthread_mutex_unlock */
+
+#include "sudoku.h"
+#include "sudoku_archive.h"
+#include "sudoku_util.h"
+
+#define ARCHIVE_FILE_MAGIC "SDKA"
+#define ARCHIVE_BLOCK_MAGIC "SDKB"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_FILE_HEADER_SIZE 8
+#define ARCHIVE_BLOCK_HEADER_SIZE 16
+#define ARCHIVE_BLOCK_SLACK 16
+#define ARCHIVE_DIMENSION 9
+#define ARCHIVE_ALL_DIGITS 0x1FF
+#define RANGE_TOP (1U << 24)
+#define COUNT_SYMBOLS (SUDOKU_CELLS + 1)
+#define COUNT_INCREMENT 32
+#define COUNT_LIMIT (1U << 16)
+/*  ==================================  */
+/*  ENUMERATIONS & TYPES                */
+/*  ==================================  */
+typedef struct Range_Encoder
+{
+    uint64_t low;
+    uint32_t range;
+    unsigned char cache;
+    uint64_t cache_size;
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    int failed;
+} range_encoder_t;
+
+typedef struct Range_Decoder
+{
+    uint32_t code;
+    uint32_t range;
+    uint32_t step;
+    const unsigned char *data;
+    size_t size;
+    size_t position;
+} range_decoder_t;
+
+/* Adaptive frequencies of the clue count, puzzles in a collection tend to share it */
+typedef struct Count_Model
+{
+    unsigned int frequency[COUNT_SYMBOLS];
+    unsigned int total;
+} count_model_t;
+
+struct Sudoku_Archive_Writer
+{
+    FILE *file;
+    range_encoder_t encoder;
+    count_model_t model;
+    size_t block_puzzles;
+    int failed;
+};
+
+struct Sudoku_Archive_Reader
+{
+    FILE *file;
+    pthread_mutex_t lock;
+    sudoku_archive_block_t block;
+    unsigned char *puzzles;
+    size_t puzzle_count;
+    size_t next_puzzle;
+};
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static int IsValidPuzzle(const unsigned char *puzzle);
+static void EncodePuzzle(range_encoder_t *encoder, count_model_t *model, const unsigned char *puzzle);
+static int DecodePuzzle(range_decoder_t *decoder, count_model_t *model, unsigned char *puzzle);
+static int FlushBlock(sudoku_archive_writer_t *writer);
+static void ResetEncoder(range_encoder_t *encoder);
+static void EncodeRange(range_encoder_t *encoder, uint32_t start, uint32_t size, uint32_t total);
+static void ShiftLow(range_encoder_t *encoder);
+static void PutByte(range_encoder_t *encoder, unsigned char byte);
+static void FinishEncoder(range_encoder_t *encoder);
+static void StartDecoder(range_decoder_t *decoder, const unsigned char *data, size_t size);
+static uint32_t GetFrequency(range_decoder_t *decoder, uint32_t total);
+static void DecodeRange(range_decoder_t *decoder, uint32_t start, uint32_t size);
+static void ResetModel(count_model_t *model);
+static void EncodeCount(range_encoder_t *encoder, count_model_t *model, unsigned int count);
+static unsigned int DecodeCount(range_decoder_t *decoder, count_model_t *model);
+static void UpdateModel(count_model_t *model, unsigned int symbol);
+static unsigned int GetBox(size_t cell);
+static int ReadBlockHeader(FILE *file, size_t *puzzle_count, size_t *size, uint32_t *checksum);
+
+/*  =================================   */
+/*  API Functions Implementation        */
+/*  =================================   */
+sudoku_archive_writer_t *SudokuArchiveCreate(const char *file_path)
+{
+    unsigned char header[ARCHIVE_FILE_HEADER_SIZE] = {0};
+
+    sudoku_archive_writer_t *writer = (sudoku_archive_writer_t *)calloc(1, sizeof(sudoku_archive_writer_t));
+    if (NULL == writer)
+    {
+        return NULL;
+    }
+
+    writer->file = fopen(file_path, "wb");
+    if (NULL == writer->file)
+    {
+        free(writer);
+        return NULL;
+    }
+
+    memcpy(header, ARCHIVE_FILE_MAGIC, 4);
+    header[4] = ARCHIVE_VERSION;
+    if (ARCHIVE_FILE_HEADER_SIZE != fwrite(header, 1, ARCHIVE_FILE_HEADER_SIZE, writer->file))
+    {
+        writer->failed = 1;
+    }
+
+    ResetEncoder(&writer->encoder);
+    ResetModel(&writer->model);
+
+    return writer;
+}
+
+int SudokuArchiveWrite(sudoku_archive_writer_t *writer, const unsigned char *puzzle)
+{
+    if (!IsValidPuzzle(puzzle))
+    {
+        return 1;
+    }
+
+    EncodePuzzle(&writer->encoder, &writer->model, puzzle);
+    ++writer->block_puzzles;
+
+    if (SUDOKU_ARCHIVE_BLOCK_PUZZLES == writer->block_puzzles)
+    {
+        writer->failed |= FlushBlock(writer);
+    }
+
+    return writer->failed;
+}
+
+int SudokuArchiveClose(sudoku_archive_writer_t *writer)
+{
+    int failed = 0;
+
+    if (0 != writer->block_puzzles)
+    {
+        writer->failed |= FlushBlock(writer);
+    }
+
+    failed = writer->failed | (0 != fclose(writer->file));
+
+    free(writer->encoder.data);
+    free(writer);
+
+    return failed;
+}
+
+sudoku_archive_reader_t *SudokuArchiveOpen(const char *file_path)
+{
+    unsigned char header[ARCHIVE_FILE_HEADER_SIZE];
+
+    sudoku_archive_reader_t *reader = (sudoku_archive_reader_t *)calloc(1, sizeof(sudoku_archive_reader_t));
+    if (NULL == reader)
+    {
+        return NULL;
+    }
+
+    reader->file = fopen(file_path, "rb");
+    if (NULL == reader->file)
+    {
+        free(reader);
+        return NULL;
+    }
+
+    if ((ARCHIVE_FILE_HEADER_SIZE != fread(header, 1, ARCHIVE_FILE_HEADER_SIZE, reader->file)) ||
+        (0 != memcmp(header, ARCHIVE_FILE_MAGIC, 4)) || (ARCHIVE_VERSION != header[4]))
+    {
+        fclose(reader->file);
+        free(reader);
+        return NULL;
+    }
+
+    pthread_mutex_init(&reader->lock, NULL);
+
+    return reader;
+}
+
+void SudokuArchiveCloseReader(sudoku_archive_reader_t *reader)
+{
+    pthread_mutex_destroy(&reader->lock);
+    fclose(reader->file);
+    SudokuArchiveFreeBlock(&reader->block);
+    free(reader->puzzles);
+    free(reader);
+}
+
+int SudokuArchiveNextBlock(sudoku_archive_reader_t *reader, sudoku_archive_block_t *block)
+{
+    size_t puzzle_count = 0;
+    size_t size = 0;
+    uint32_t checksum = 0;
+    unsigned char *data = NULL;
+    int status = 0;
+
+    pthread_mutex_lock(&reader->lock);
+
+    status = ReadBlockHeader(reader->file, &puzzle_count, &size, &checksum);
+    if (1 == status)
+    {
+        if (block->capacity < size)
+        {
+            data = (unsigned char *)realloc(block->data, size);
+            if (NULL == data)
+            {
+                pthread_mutex_unlock(&reader->lock);
+                return -1;
+            }
+            block->data = data;
+            block->capacity = size;
+        }
+
+        if ((size != fread(block->data, 1, size, reader->file)) || (checksum != SudokuChecksum(block->data, size)))
+        {
+            status = -1;
+        }
+
+        block->size = size;
+        block->puzzle_count = puzzle_count;
+    }
+
+    pthread_mutex_unlock(&reader->lock);
+
+    return status;
+}
+
+int SudokuArchiveSkipBlock(sudoku_archive_reader_t *reader)
+{
+    size_t puzzle_count = 0;
+    size_t size = 0;
+    uint32_t checksum = 0;
+    int status = 0;
+
+    pthread_mutex_lock(&reader->lock);
+
+    status = ReadBlockHeader(reader->file, &puzzle_count, &size, &checksum);
+    if ((1 == status) && (0 != fseek(reader->file, (long)size, SEEK_CUR)))
+    {
+        status = -1;
+    }
+
+    pthread_mutex_unlock(&reader->lock);
+
+    return status;
+}
+
+void SudokuArchiveRewind(sudoku_archive_reader_t *reader)
+{
+    pthread_mutex_lock(&reader->lock);
+
+    fseek(reader->file, ARCHIVE_FILE_HEADER_SIZE, SEEK_SET);
+    reader->puzzle_count = 0;
+    reader->next_puzzle = 0;
+
+    pthread_mutex_unlock(&reader->lock);
+}
+
+size_t SudokuArchiveDecodeBlock(const sudoku_archive_block_t *block, unsigned char *puzzles, size_t max_puzzles)
+{
+    range_decoder_t decoder;
+    count_model_t model;
+    size_t count = 0;
+
+    StartDecoder(&decoder, block->data, block->size);
+    ResetModel(&model);
+
+    while ((count < block->puzzle_count) && (count < max_puzzles))
+    {
+        if (!DecodePuzzle(&decoder, &model, puzzles + count * SUDOKU_CELLS))
+        {
+            break;
+        }
+        ++count;
+    }
+
+    return count;
+}
+
+void SudokuArchiveFreeBlock(sudoku_archive_block_t *block)
+{
+    free(block->data);
+    block->data = NULL;
+    block->size = 0;
+    block->capacity = 0;
+    block->puzzle_count = 0;
+}
+
+size_t SudokuArchiveRead(sudoku_archive_reader_t *reader, unsigned char *puzzles, size_t max_puzzles)
+{
+    size_t count = 0;
+    size_t chunk = 0;
+
+    if (NULL == reader->puzzles)
+    {
+        reader->puzzles = (unsigned char *)malloc((size_t)SUDOKU_ARCHIVE_BLOCK_PUZZLES * SUDOKU_CELLS);
+        if (NULL == reader->puzzles)
+        {
+            return 0;
+        }
+    }
+
+    while (count < max_puzzles)
+    {
+        if (reader->next_puzzle == reader->puzzle_count)
+        {
+            if (1 != SudokuArchiveNextBlock(reader, &reader->block))
+            {
+                break;
+            }
+
+            reader->puzzle_count = SudokuArchiveDecodeBlock(&reader->block, reader->puzzles, SUDOKU_ARCHIVE_BLOCK_PUZZLES);
+            reader->next_puzzle = 0;
+            continue;
+        }
+
+        chunk = reader->puzzle_count - reader->next_puzzle;
+        if (chunk > max_puzzles - count)
+        {
+            chunk = max_puzzles - count;
+        }
+
+        memcpy(puzzles + count * SUDOKU_CELLS, reader->puzzles + reader->next_puzzle * SUDOKU_CELLS, chunk * SUDOKU_CELLS);
+        reader->next_puzzle += chunk;
+        count += chunk;
+    }
+
+    return count;
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static int IsValidPuzzle(const unsigned char *puzzle)
+{
+    unsigned int row_used[ARCHIVE_DIMENSION] = {0};
+    unsigned int col_used[ARCHIVE_DIMENSION] = {0};
+    unsigned int box_used[ARCHIVE_DIMENSION] = {0};
+    unsigned int bit = 0;
+    size_t cell = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (0 == puzzle[cell])
+        {
+            continue;
+        }
+        if (ARCHIVE_DIMENSION < puzzle[cell])
+        {
+            return 0;
+        }
+
+        bit = 1U << (puzzle[cell] - 1);
+        if ((row_used[cell / 9] | col_used[cell % 9] | box_used[GetBox(cell)]) & bit)
+        {
+            return 0;
+        }
+
+        row_used[cell / 9] |= bit;
+        col_used[cell % 9] |= bit;
+        box_used[GetBox(cell)] |= bit;
+    }
+
+    return 1;
+}
+
+static void EncodePuzzle(range_encoder_t *encoder, count_model_t *model, const unsigned char *puzzle)
+{
+    unsigned int row_used[ARCHIVE_DIMENSION] = {0};
+    unsigned int col_used[ARCHIVE_DIMENSION] = {0};
+    unsigned int box_used[ARCHIVE_DIMENSION] = {0};
+    unsigned int clues = 0;
+    unsigned int clues_left = 0;
+    unsigned int cells_left = SUDOKU_CELLS;
+    unsigned int candidates = 0;
+    unsigned int bit = 0;
+    size_t cell = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        clues += (0 != puzzle[cell]);
+    }
+
+    EncodeCount(encoder, model, clues);
+
+    /* Clue positions: each cell is a clue with probability clues_left / cells_left */
+    clues_left = clues;
+    for (cell = 0; (cell < SUDOKU_CELLS) && (0 != clues_left) && (clues_left != cells_left); ++cell, --cells_left)
+    {
+        if (0 != puzzle[cell])
+        {
+            EncodeRange(encoder, 0, clues_left, cells_left);
+            --clues_left;
+        }
+        else
+        {
+            EncodeRange(encoder, clues_left, cells_left - clues_left, cells_left);
+        }
+    }
+
+    /* Clue digits: the index among the digits the earlier clues still allow */
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (0 == puzzle[cell])
+        {
+            continue;
+        }
+
+        bit = 1U << (puzzle[cell] - 1);
+        candidates = ARCHIVE_ALL_DIGITS & ~(row_used[cell / 9] | col_used[cell % 9] | box_used[GetBox(cell)]);
+
+        if (1 < SudokuCountBits(candidates))
+        {
+            EncodeRange(encoder, SudokuCountBits(candidates & (bit - 1)), 1, SudokuCountBits(candidates));
+        }
+
+        row_used[cell / 9] |= bit;
+        col_used[cell % 9] |= bit;
+        box_used[GetBox(cell)] |= bit;
+    }
+}
+
+static int DecodePuzzle(range_decoder_t *decoder, count_model_t *model, unsigned char *puzzle)
+{
+    unsigned int row_used[ARCHIVE_DIMENSION] = {0};
+    unsigned int col_used[ARCHIVE_DIMENSION] = {0};
+    unsigned int box_used[ARCHIVE_DIMENSION] = {0};
+    unsigned int clues = 0;
+    unsigned int clues_left = 0;
+    unsigned int cells_left = SUDOKU_CELLS;
+    unsigned int candidates = 0;
+    unsigned int index = 0;
+    unsigned int digit = 0;
+    size_t cell = 0;
+
+    clues = DecodeCount(decoder, model);
+
+    clues_left = clues;
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell, --cells_left)
+    {
+        if (0 == clues_left)
+        {
+            puzzle[cell] = 0;
+        }
+        else if (clues_left == cells_left)
+        {
+            puzzle[cell] = 1; /* Every remaining cell is a clue */
+            --clues_left;
+        }
+        else if (GetFrequency(decoder, cells_left) < clues_left)
+        {
+            DecodeRange(decoder, 0, clues_left);
+            puzzle[cell] = 1;
+            --clues_left;
+        }
+        else
+        {
+            DecodeRange(decoder, clues_left, cells_left - clues_left);
+            puzzle[cell] = 0;
+        }
+    }
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (0 == puzzle[cell])
+        {
+            continue;
+        }
+
+        candidates = ARCHIVE_ALL_DIGITS & ~(row_used[cell / 9] | col_used[cell % 9] | box_used[GetBox(cell)]);
+        if (0 == candidates)
+        {
+            return 0; /* Only a damaged block can get here */
+        }
+
+        index = 0;
+        if (1 < SudokuCountBits(candidates))
+        {
+            index = GetFrequency(decoder, SudokuCountBits(candidates));
+            DecodeRange(decoder, index, 1);
+        }
+
+        /* Drop the lower candidates to reach the chosen one */
+        while (0 != index--)
+        {
+            candidates &= candidates - 1;
+        }
+        candidates &= ~(candidates - 1);
+
+        for (digit = 1; 1 != candidates; ++digit)
+        {
+            candidates >>= 1;
+        }
+
+        puzzle[cell] = (unsigned char)digit;
+        row_used[cell / 9] |= 1U << (digit - 1);
+        col_used[cell % 9] |= 1U << (digit - 1);
+        box_used[GetBox(cell)] |= 1U << (digit - 1);
+    }
+
+    return 1;
+}
+
+static int FlushBlock(sudoku_archive_writer_t *writer)
+{
+    unsigned char header[ARCHIVE_BLOCK_HEADER_SIZE];
+    int failed = 0;
+
+    FinishEncoder(&writer->encoder);
+
+    memcpy(header, ARCHIVE_BLOCK_MAGIC, 4);
+    SudokuPutUInt32(header + 4, (uint32_t)writer->block_puzzles);
+    SudokuPutUInt32(header + 8, (uint32_t)writer->encoder.size);
+    SudokuPutUInt32(header + 12, SudokuChecksum(writer->encoder.data, writer->encoder.size));
+
+    failed = writer->encoder.failed;
+    failed |= (ARCHIVE_BLOCK_HEADER_SIZE != fwrite(header, 1, ARCHIVE_BLOCK_HEADER_SIZE, writer->file));
+    failed |= (writer->encoder.size != fwrite(writer->encoder.data, 1, writer->encoder.size, writer->file));
+
+    /* Every block starts from a fresh coder and model so it decodes on its own */
+    ResetEncoder(&writer->encoder);
+    ResetModel(&writer->model);
+    writer->block_puzzles = 0;
+
+    return failed;
+}
+
+static void ResetEncoder(range_encoder_t *encoder)
+{
+    encoder->low = 0;
+    encoder->range = 0xFFFFFFFFU;
+    encoder->cache = 0;
+    encoder->cache_size = 1;
+    encoder->size = 0;
+    encoder->failed = 0;
+}
+
+static void EncodeRange(range_encoder_t *encoder, uint32_t start, uint32_t size, uint32_t total)
+{
+    uint32_t step = encoder->range / total;
+
+    encoder->low += (uint64_t)step * start;
+    encoder->range = step * size;
+
+    while (encoder->range < RANGE_TOP)
+    {
+        encoder->range <<= 8;
+        ShiftLow(encoder);
+    }
+}
+
+static void ShiftLow(range_encoder_t *encoder)
+{
+    unsigned char carry = 0;
+
+    /* Hold back 0xFF bytes until it is known whether a carry reaches them */
+    if ((encoder->low < 0xFF000000ULL) || (encoder->low > 0xFFFFFFFFULL))
+    {
+        carry = (unsigned char)(encoder->low >> 32);
+
+        PutByte(encoder, (unsigned char)(encoder->cache + carry));
+        while (0 != --encoder->cache_size)
+        {
+            PutByte(encoder, (unsigned char)(0xFF + carry));
+        }
+
+        encoder->cache = (unsigned char)(encoder->low >> 24);
+    }
+
+    ++encoder->cache_size;
+    encoder->low = (encoder->low & 0x00FFFFFFULL) << 8;
+}
+
+static void PutByte(range_encoder_t *encoder, unsigned char byte)
+{
+    unsigned char *data = NULL;
+
+    if (encoder->size == encoder->capacity)
+    {
+        data = (unsigned char *)realloc(encoder->data, 2 * encoder->capacity + 256);
+        if (NULL == data)
+        {
+            encoder->failed = 1;
+            return;
+        }
+        encoder->data = data;
+        encoder->capacity = 2 * encoder->capacity + 256;
+    }
+
+    encoder->data[encoder->size++] = byte;
+}
+
+static void FinishEncoder(range_encoder_t *encoder)
+{
+    size_t i = 0;
+
+    for (i = 0; i < 5; ++i)
+    {
+        ShiftLow(encoder);
+    }
+}
+
+static void StartDecoder(range_decoder_t *decoder, const unsigned char *data, size_t size)
+{
+    size_t i = 0;
+
+    decoder->code = 0;
+    decoder->range = 0xFFFFFFFFU;
+    decoder->step = 1;
+    decoder->data = data;
+    decoder->size = size;
+    decoder->position = 0;
+
+    /* The first byte is the encoder's initial cache and carries no information */
+    for (i = 0; i < 5; ++i)
+    {
+        decoder->code = (decoder->code << 8) | ((decoder->position < size) ? data[decoder->position] : 0);
+        ++decoder->position;
+    }
+}
+
+static uint32_t GetFrequency(range_decoder_t *decoder, uint32_t total)
+{
+    uint32_t value = 0;
+
+    decoder->step = decoder->range / total;
+    value = decoder->code / decoder->step;
+
+    return (value < total) ? value : total - 1;
+}
+
+static void DecodeRange(range_decoder_t *decoder, uint32_t start, uint32_t size)
+{
+    decoder->code -= decoder->step * start;
+    decoder->range = decoder->step * size;
+
+    while (decoder->range < RANGE_TOP)
+    {
+        decoder->code = (decoder->code << 8) |
+                        ((decoder->position < decoder->size) ? decoder->data[decoder->position] : 0);
+        ++decoder->position;
+        decoder->range <<= 8;
+    }
+}
+
+static void ResetModel(count_model_t *model)
+{
+    size_t symbol = 0;
+
+    for (symbol = 0; symbol < COUNT_SYMBOLS; ++symbol)
+    {
+        model->frequency[symbol] = 1;
+    }
+    model->total = COUNT_SYMBOLS;
+}
+
+static void EncodeCount(range_encoder_t *encoder, count_model_t *model, unsigned int count)
+{
+    unsigned int start = 0;
+    unsigned int symbol = 0;
+
+    for (symbol = 0; symbol < count; ++symbol)
+    {
+        start += model->frequency[symbol];
+    }
+
+    EncodeRange(encoder, start, model->frequency[count], model->total);
+    UpdateModel(model, count);
+}
+
+static unsigned int DecodeCount(range_decoder_t *decoder, count_model_t *model)
+{
+    unsigned int target = GetFrequency(decoder, model->total);
+    unsigned int start = 0;
+    unsigned int symbol = 0;
+
+    while ((symbol < COUNT_SYMBOLS - 1) && (start + model->frequency[symbol] <= target))
+    {
+        start += model->frequency[symbol];
+        ++symbol;
+    }
+
+    DecodeRange(decoder, start, model->frequency[symbol]);
+    UpdateModel(model, symbol);
+
+    return symbol;
+}
+
+static void UpdateModel(count_model_t *model, unsigned int symbol)
+{
+    size_t i = 0;
+
+    model->frequency[symbol] += COUNT_INCREMENT;
+    model->total += COUNT_INCREMENT;
+
+    /* Halve the counts to keep the total inside the coder's precision */
+    if (COUNT_LIMIT < model->total)
+    {
+        model->total = 0;
+        for (i = 0; i < COUNT_SYMBOLS; ++i)
+        {
+            model->frequency[i] = (model->frequency[i] + 1) / 2;
+            model->total += model->frequency[i];
+        }
+    }
+}
+
+static unsigned int GetBox(size_t cell)
+{
+    return (unsigned int)((cell / 27) * 3 + (cell % 9) / 3);
+}
+
+static int ReadBlockHeader(FILE *file, size_t *puzzle_count, size_t *size, uint32_t *checksum)
+{
+    unsigned char header[ARCHIVE_BLOCK_HEADER_SIZE];
+    size_t read = fread(header, 1, ARCHIVE_BLOCK_HEADER_SIZE, file);
+
+    if (0 == read)
+    {
+        return 0;
+    }
+    if ((ARCHIVE_BLOCK_HEADER_SIZE != read) || (0 != memcmp(header, ARCHIVE_BLOCK_MAGIC, 4)))
+    {
+        return -1;
+    }
+
+    *puzzle_count = SudokuGetUInt32(header + 4);
+    *size = SudokuGetUInt32(header + 8);
+    *checksum = SudokuGetUInt32(header + 12);
+
+    /* A coded puzzle never takes more bytes than its text, so larger sizes can only come from damage */
+    if ((SUDOKU_ARCHIVE_BLOCK_PUZZLES < *puzzle_count) || (*puzzle_count * SUDOKU_CELLS + ARCHIVE_BLOCK_SLACK < *size))
+    {
+        return -1;
+    }
+
+    return 1;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file sudoku_archive.h
+ * @brief Sudoku Puzzle Archive Interface
+ *
+ * This header file provides the interface for reading and writing
+ * compact archives of puzzles. Each puzzle is stored as its clue
+ * count, the positions of its clues and, for every clue, the index of
+ * its digit among the digits still legal in that cell, all range-coded
+ * (typically 14-20 bytes per puzzle instead of an 82-byte text line).
+ *
+ * Puzzles are grouped in blocks with their own header and coder state,
+ * so every block can be decoded on its own: one thread may pull raw
+ * blocks with SudokuArchiveNextBlock while many threads decode them
+ * with SudokuArchiveDecodeBlock.
+ *
+ * @author [Zayd Abu Sneineh]
+ */
+
+#ifndef SUDOKU_ARCHIVE_H
+#define SUDOKU_ARCHIVE_H
+
+#include <stddef.h> /* size_t */
+
+/**
+ * @def SUDOKU_ARCHIVE_BLOCK_PUZZLES
+ * Maximum number of puzzles in a block.
+ */
+#define SUDOKU_ARCHIVE_BLOCK_PUZZLES 4096
+
+/**
+ * @typedef sudoku_archive_writer_t
+ * Typedef for the archive writer structure.
+ * The structure is defined in the implementation file.
+ */
+typedef struct Sudoku_Archive_Writer sudoku_archive_writer_t;
+
+/**
+ * @typedef sudoku_archive_reader_t
+ * Typedef for the archive reader structure.
+ * The structure is defined in the implementation file.
+ */
+typedef struct Sudoku_Archive_Reader sudoku_archive_reader_t;
+
+/**
+ * @struct Sudoku_Archive_Block
+ * A raw (still encoded) block, as read from the archive.
+ */
+typedef struct Sudoku_Archive_Block
+{
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    size_t puzzle_count;
+} sudoku_archive_block_t;
+
+/**
+ * @brief Create an archive, replacing any file at that path.
+ *
+ * @return The new writer, or NULL if the file cannot be created.
+ */
+sudoku_archive_writer_t *SudokuArchiveCreate(const char *file_path);
+
+/**
+ * @brief Add a puzzle to the archive.
+ *
+ * @param puzzle 81 cells in row-major order, 0 for empty cells.
+ * @return 0 on success, 1 if the puzzle breaks the rules or the write failed.
+ */
+int SudokuArchiveWrite(sudoku_archive_writer_t *writer, const unsigned char *puzzle);
+
+/**
+ * @brief Write the last block and close the archive.
+ *
+ * @return 0 on success, 1 if a write failed.
+ */
+int SudokuArchiveClose(sudoku_archive_writer_t *writer);
+
+/**
+ * @brief Open an archive for reading.
+ *
+ * @return The new reader, or NULL if the file is missing or not an archive.
+ */
+sudoku_archive_reader_t *SudokuArchiveOpen(const char *file_path);
+
+/**
+ * @brief Close an archive opened with SudokuArchiveOpen.
+ */
+void SudokuArchiveCloseReader(sudoku_archive_reader_t *reader);
+
+/**
+ * @brief Read the next raw block. Safe to call from several threads.
+ *
+ * @param block Receives the block; its buffer is grown as needed and
+ *              must be released with SudokuArchiveFreeBlock.
+ * @return 1 if a block was read, 0 at the end, -1 if the archive is damaged.
+ */
+int SudokuArchiveNextBlock(sudoku_archive_reader_t *reader, sudoku_archive_block_t *block);
+
+/**
+ * @brief Skip the next block without reading its payload.
+ *
+ * @return 1 if a block was skipped, 0 at the end, -1 if the archive is damaged.
+ */
+int SudokuArchiveSkipBlock(sudoku_archive_reader_t *reader);
+
+/**
+ * @brief Go back to the first block.
+ */
+void SudokuArchiveRewind(sudoku_archive_reader_t *reader);
+
+/**
+ * @brief Decode a raw block. Touches no shared state.
+ *
+ * @param puzzles Receives up to max_puzzles puzzles of 81 cells each.
+ * @return Number of puzzles decoded.
+ */
+size_t SudokuArchiveDecodeBlock(const sudoku_archive_block_t *block, unsigned char *puzzles, size_t max_puzzles);
+
+/**
+ * @brief Release the buffer of a block.
+ */
+void SudokuArchiveFreeBlock(sudoku_archive_block_t *block);
+
+/**
+ * @brief Read puzzles in order, decoding blocks as needed.
+ *
+ * @param puzzles Receives up to max_puzzles puzzles of 81 cells each,
+ *                ready to be passed to SolveSudokuBatch.
+ * @return Number of puzzles read, 0 at the end of the archive.
+ */
+size_t SudokuArchiveRead(sudoku_archive_reader_t *reader, unsigned char *puzzles, size_t max_puzzles);
+
+#endif /* SUDOKU_ARCHIVE_H */
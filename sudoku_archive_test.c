@@ -0,0 +1,193 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#include <stdio.h>  /* printf, fprintf, fopen, fseek, fread, fwrite, fclose, remove */
+#include <stdlib.h> /* EXIT_FAILURE, EXIT_SUCCESS, malloc, free */
+#include <string.h> /* memcmp */
+
+#include "sudoku.h"
+#include "sudoku_archive.h"
+
+#define TEST_ARCHIVE_FILE "sudoku_archive_test.sdka"
+#define TEST_PUZZLES 5000      /* More than one block */
+#define TEST_FILE_HEADER_SIZE 8
+#define TEST_BLOCK_HEADER_SIZE 16
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static void MakePuzzle(unsigned long seed, unsigned char *puzzle);
+static int CheckRoundTrip(const unsigned char *puzzles);
+static int CheckCorruption(long offset, unsigned char flip);
+static int PatchFile(long offset, unsigned char flip);
+static int Fail(const char *message);
+
+/*  =================================   */
+/*  API Functions Implementation        */
+/*  =================================   */
+int main()
+{
+    unsigned char *puzzles = (unsigned char *)malloc((size_t)TEST_PUZZLES * SUDOKU_CELLS);
+    unsigned long i = 0;
+    int failed = 0;
+
+    if (NULL == puzzles)
+    {
+        return Fail("memory allocation");
+    }
+
+    for (i = 0; i < TEST_PUZZLES; ++i)
+    {
+        MakePuzzle(i, puzzles + i * SUDOKU_CELLS);
+    }
+
+    /* A flipped payload byte breaks the checksum, a flipped size byte the size bound */
+    failed |= CheckRoundTrip(puzzles) || CheckCorruption(TEST_FILE_HEADER_SIZE + TEST_BLOCK_HEADER_SIZE + 5, 0x10);
+    failed |= CheckRoundTrip(puzzles) || CheckCorruption(TEST_FILE_HEADER_SIZE + 11, 0x7F);
+
+    free(puzzles);
+    remove(TEST_ARCHIVE_FILE);
+
+    if (failed)
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("archive: all checks passed\n");
+
+    return EXIT_SUCCESS;
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static void MakePuzzle(unsigned long seed, unsigned char *puzzle)
+{
+    unsigned long long random = 0x9E3779B97F4A7C15ULL * (seed + 1);
+    size_t cell = 0;
+    size_t row = 0;
+    size_t col = 0;
+
+    /* A shifted pattern is a valid grid; keep about a third of it, differently for every seed */
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+
+        row = cell / 9;
+        col = cell % 9;
+        puzzle[cell] = (0 == random % 3) ? (unsigned char)((row * 3 + row / 3 + col + seed) % 9 + 1) : 0;
+    }
+}
+
+static int CheckRoundTrip(const unsigned char *puzzles)
+{
+    unsigned char invalid[SUDOKU_CELLS] = {0};
+    unsigned char *read = NULL;
+    sudoku_archive_writer_t *writer = NULL;
+    sudoku_archive_reader_t *reader = NULL;
+    size_t count = 0;
+    size_t i = 0;
+    int failed = 0;
+
+    writer = SudokuArchiveCreate(TEST_ARCHIVE_FILE);
+    if (NULL == writer)
+    {
+        return Fail("cannot create the archive");
+    }
+
+    for (i = 0; i < TEST_PUZZLES; ++i)
+    {
+        failed |= SudokuArchiveWrite(writer, puzzles + i * SUDOKU_CELLS);
+    }
+
+    /* Two equal digits in a row are refused */
+    invalid[0] = 5;
+    invalid[1] = 5;
+    if (0 == SudokuArchiveWrite(writer, invalid))
+    {
+        failed |= Fail("a puzzle breaking the rules was written");
+    }
+
+    if (failed || SudokuArchiveClose(writer))
+    {
+        return Fail("writing the archive");
+    }
+
+    read = (unsigned char *)malloc((size_t)(TEST_PUZZLES + 1) * SUDOKU_CELLS);
+    reader = SudokuArchiveOpen(TEST_ARCHIVE_FILE);
+    if ((NULL == read) || (NULL == reader))
+    {
+        free(read);
+        return Fail("cannot open the archive");
+    }
+
+    count = SudokuArchiveRead(reader, read, TEST_PUZZLES + 1);
+    if ((TEST_PUZZLES != count) || (0 != memcmp(read, puzzles, (size_t)TEST_PUZZLES * SUDOKU_CELLS)))
+    {
+        failed = Fail("the puzzles read back differ from the puzzles written");
+    }
+
+    SudokuArchiveCloseReader(reader);
+    free(read);
+
+    return failed;
+}
+
+static int CheckCorruption(long offset, unsigned char flip)
+{
+    sudoku_archive_block_t block = {NULL, 0, 0, 0};
+    sudoku_archive_reader_t *reader = NULL;
+    int status = 0;
+
+    if (PatchFile(offset, flip))
+    {
+        return Fail("cannot damage the archive");
+    }
+
+    reader = SudokuArchiveOpen(TEST_ARCHIVE_FILE);
+    if (NULL == reader)
+    {
+        return Fail("cannot open the damaged archive");
+    }
+
+    status = SudokuArchiveNextBlock(reader, &block);
+    SudokuArchiveFreeBlock(&block);
+    SudokuArchiveCloseReader(reader);
+
+    if (-1 != status)
+    {
+        return Fail("a damaged block was accepted");
+    }
+
+    return 0;
+}
+
+static int PatchFile(long offset, unsigned char flip)
+{
+    FILE *file = fopen(TEST_ARCHIVE_FILE, "r+b");
+    unsigned char byte = 0;
+    int failed = 0;
+
+    if (NULL == file)
+    {
+        return 1;
+    }
+
+    failed = (0 != fseek(file, offset, SEEK_SET)) || (1 != fread(&byte, 1, 1, file));
+    byte ^= flip;
+    failed = failed || (0 != fseek(file, offset, SEEK_SET)) || (1 != fwrite(&byte, 1, 1, file));
+    failed |= (0 != fclose(file));
+
+    return failed;
+}
+
+static int Fail(const char *message)
+{
+    fprintf(stderr, "archive: FAILED: %s\n", message);
+
+    return 1;
+}
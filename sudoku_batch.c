@@ -0,0 +1,416 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#include <string.h> /* memcpy */
+
+#include "sudoku.h"
+#include "sudoku_batch.h"
+#include "sudoku_util.h"
+
+#define BATCH_UNITS 27
+#define BATCH_DIMENSION 9
+#define BATCH_ALL_DIGITS 0x1FF
+/*  ==================================  */
+/*  ENUMERATIONS & TYPES                */
+/*  ==================================  */
+/* One 16-bit candidate mask per puzzle, held in a single (GCC/Clang) vector */
+typedef unsigned short lanes_t __attribute__((vector_size(2 * SUDOKU_BATCH_LANES)));
+
+typedef struct Batch_Block
+{
+    lanes_t candidates[SUDOKU_CELLS];
+    lanes_t dead; /* Non-zero in a lane once it hits a contradiction */
+} batch_block_t;
+
+/*  ==================================  */
+/*	Global Variables                    */
+/*  ==================================  */
+static const unsigned char unit_cells[BATCH_UNITS][BATCH_DIMENSION] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8},
+    {9, 10, 11, 12, 13, 14, 15, 16, 17},
+    {18, 19, 20, 21, 22, 23, 24, 25, 26},
+    {27, 28, 29, 30, 31, 32, 33, 34, 35},
+    {36, 37, 38, 39, 40, 41, 42, 43, 44},
+    {45, 46, 47, 48, 49, 50, 51, 52, 53},
+    {54, 55, 56, 57, 58, 59, 60, 61, 62},
+    {63, 64, 65, 66, 67, 68, 69, 70, 71},
+    {72, 73, 74, 75, 76, 77, 78, 79, 80},
+    {0, 9, 18, 27, 36, 45, 54, 63, 72},
+    {1, 10, 19, 28, 37, 46, 55, 64, 73},
+    {2, 11, 20, 29, 38, 47, 56, 65, 74},
+    {3, 12, 21, 30, 39, 48, 57, 66, 75},
+    {4, 13, 22, 31, 40, 49, 58, 67, 76},
+    {5, 14, 23, 32, 41, 50, 59, 68, 77},
+    {6, 15, 24, 33, 42, 51, 60, 69, 78},
+    {7, 16, 25, 34, 43, 52, 61, 70, 79},
+    {8, 17, 26, 35, 44, 53, 62, 71, 80},
+    {0, 1, 2, 9, 10, 11, 18, 19, 20},
+    {3, 4, 5, 12, 13, 14, 21, 22, 23},
+    {6, 7, 8, 15, 16, 17, 24, 25, 26},
+    {27, 28, 29, 36, 37, 38, 45, 46, 47},
+    {30, 31, 32, 39, 40, 41, 48, 49, 50},
+    {33, 34, 35, 42, 43, 44, 51, 52, 53},
+    {54, 55, 56, 63, 64, 65, 72, 73, 74},
+    {57, 58, 59, 66, 67, 68, 75, 76, 77},
+    {60, 61, 62, 69, 70, 71, 78, 79, 80}};
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static void LoadBlock(batch_block_t *block, const unsigned char *puzzles, size_t count);
+static void PropagateBlock(batch_block_t *block);
+static int PropagateScalar(unsigned short *candidates);
+static void SearchScalar(const unsigned short *candidates, unsigned char *solution, unsigned int *solution_count, unsigned int limit);
+static void WriteSolution(const unsigned short *candidates, unsigned char *solution);
+
+/*  =================================   */
+/*  API Functions Implementation        */
+/*  =================================   */
+size_t SolveSudokuBatch(const unsigned char *puzzles, unsigned char *solutions, unsigned char *solved, size_t count)
+{
+    batch_block_t block;
+    unsigned short lane_candidates[SUDOKU_CELLS];
+    unsigned int solution_count = 0;
+    size_t first = 0;
+    size_t lanes = 0;
+    size_t lane = 0;
+    size_t cell = 0;
+    size_t solved_count = 0;
+    int branching = 0;
+
+    for (first = 0; first < count; first += SUDOKU_BATCH_LANES)
+    {
+        lanes = ((count - first) < SUDOKU_BATCH_LANES) ? (count - first) : SUDOKU_BATCH_LANES;
+
+        LoadBlock(&block, puzzles + first * SUDOKU_CELLS, lanes);
+        PropagateBlock(&block);
+
+        for (lane = 0; lane < lanes; ++lane)
+        {
+            solution_count = 0;
+            branching = 0;
+
+            for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+            {
+                lane_candidates[cell] = block.candidates[cell][lane];
+                branching |= (1 < SudokuCountBits(lane_candidates[cell]));
+            }
+
+            if (0 != block.dead[lane])
+            {
+                solution_count = 0;
+            }
+            else if (!branching)
+            {
+                WriteSolution(lane_candidates, solutions + (first + lane) * SUDOKU_CELLS);
+                solution_count = 1;
+            }
+            else
+            {
+                /* Only this lane needs to branch, finish it with the scalar engine */
+                SearchScalar(lane_candidates, solutions + (first + lane) * SUDOKU_CELLS, &solution_count, 1);
+            }
+
+            if (NULL != solved)
+            {
+                solved[first + lane] = (unsigned char)(0 != solution_count);
+            }
+            solved_count += (0 != solution_count);
+        }
+    }
+
+    return solved_count;
+}
+
+unsigned int SolveSudokuScalar(const unsigned char *puzzle, unsigned char *solution, unsigned int limit)
+{
+    unsigned short candidates[SUDOKU_CELLS];
+    unsigned char scratch[SUDOKU_CELLS];
+    unsigned int solution_count = 0;
+    size_t cell = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (BATCH_DIMENSION < puzzle[cell])
+        {
+            return 0;
+        }
+
+        candidates[cell] = (0 != puzzle[cell]) ? (unsigned short)(1 << (puzzle[cell] - 1)) : BATCH_ALL_DIGITS;
+    }
+
+    SearchScalar(candidates, (NULL != solution) ? solution : scratch, &solution_count, limit);
+
+    return solution_count;
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static void LoadBlock(batch_block_t *block, const unsigned char *puzzles, size_t count)
+{
+    size_t lane = 0;
+    size_t cell = 0;
+    unsigned int digit = 0;
+
+    for (lane = 0; lane < SUDOKU_BATCH_LANES; ++lane)
+    {
+        block->dead[lane] = 0;
+    }
+
+    for (lane = 0; lane < SUDOKU_BATCH_LANES; ++lane)
+    {
+        for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+        {
+            /* Unused lanes hold an empty board, which propagation leaves alone */
+            digit = (lane < count) ? puzzles[lane * SUDOKU_CELLS + cell] : 0;
+
+            if (BATCH_DIMENSION < digit)
+            {
+                /* Not a digit; the lane is reported unsolved, as SolveSudokuVariantPuzzle rejects it */
+                block->dead[lane] = 1;
+                block->candidates[cell][lane] = BATCH_ALL_DIGITS;
+            }
+            else if (0 != digit)
+            {
+                block->candidates[cell][lane] = (unsigned short)(1 << (digit - 1));
+            }
+            else
+            {
+                block->candidates[cell][lane] = BATCH_ALL_DIGITS;
+            }
+        }
+    }
+}
+
+static void PropagateBlock(batch_block_t *block)
+{
+    lanes_t solved;
+    lanes_t once;
+    lanes_t twice;
+    lanes_t clash;
+    lanes_t hidden;
+    lanes_t changed;
+    lanes_t value;
+    lanes_t is_single;
+    lanes_t kept;
+    lanes_t only;
+    lanes_t has_only;
+    lanes_t dead = block->dead;
+    const lanes_t zero = {0};
+    unsigned short any_changed = 0;
+    size_t unit = 0;
+    size_t i = 0;
+    size_t lane = 0;
+
+    /*
+     * Every statement below is one vector operation over all lanes. Lane
+     * dependent choices are made with masks instead of branches.
+     */
+    do
+    {
+        changed = zero;
+
+        for (unit = 0; unit < BATCH_UNITS; ++unit)
+        {
+            solved = zero;
+            once = zero;
+            twice = zero;
+            clash = zero;
+
+            /* Collect the solved digits and the digits seen once / more than once */
+            for (i = 0; i < BATCH_DIMENSION; ++i)
+            {
+                value = block->candidates[unit_cells[unit][i]];
+                is_single = (lanes_t)(0 == (value & (value - 1)));
+
+                /* A digit solved twice, or a cell without candidates, is a contradiction */
+                clash |= (solved & value & is_single) | (lanes_t)(0 == value);
+                solved |= value & is_single;
+                twice |= once & value;
+                once |= value;
+            }
+
+            hidden = once & ~twice & ~solved;
+            dead |= clash | (once ^ BATCH_ALL_DIGITS);
+
+            /* Remove solved digits from the other cells and apply hidden singles */
+            for (i = 0; i < BATCH_DIMENSION; ++i)
+            {
+                value = block->candidates[unit_cells[unit][i]];
+                is_single = (lanes_t)(0 == (value & (value - 1)));
+
+                kept = (value & is_single) | (value & ~solved & ~is_single);
+                only = kept & hidden;
+                has_only = (lanes_t)(0 != only);
+                kept = (only & has_only) | (kept & ~has_only);
+
+                /* A cell that is the only place for two digits is a contradiction */
+                dead |= only & (only - 1);
+                changed |= value ^ kept;
+                block->candidates[unit_cells[unit][i]] = kept;
+            }
+        }
+
+        /* Dead lanes are left as they are */
+        changed &= (lanes_t)(0 == dead);
+
+        any_changed = 0;
+        for (lane = 0; lane < SUDOKU_BATCH_LANES; ++lane)
+        {
+            any_changed |= changed[lane];
+        }
+    } while (0 != any_changed);
+
+    block->dead = dead;
+}
+
+static int PropagateScalar(unsigned short *candidates)
+{
+    unsigned short solved = 0;
+    unsigned short once = 0;
+    unsigned short twice = 0;
+    unsigned short hidden = 0;
+    unsigned short value = 0;
+    unsigned short kept = 0;
+    unsigned short only = 0;
+    int changed = 1;
+    size_t unit = 0;
+    size_t i = 0;
+
+    /* The same rules as PropagateBlock, for a single lane */
+    while (changed)
+    {
+        changed = 0;
+
+        for (unit = 0; unit < BATCH_UNITS; ++unit)
+        {
+            solved = 0;
+            once = 0;
+            twice = 0;
+
+            for (i = 0; i < BATCH_DIMENSION; ++i)
+            {
+                value = candidates[unit_cells[unit][i]];
+
+                if (0 == value)
+                {
+                    return 0;
+                }
+                if (0 == (value & (value - 1)))
+                {
+                    if (solved & value)
+                    {
+                        return 0;
+                    }
+                    solved |= value;
+                }
+                twice |= once & value;
+                once |= value;
+            }
+
+            if (BATCH_ALL_DIGITS != once)
+            {
+                return 0;
+            }
+
+            hidden = once & ~twice & ~solved;
+
+            for (i = 0; i < BATCH_DIMENSION; ++i)
+            {
+                value = candidates[unit_cells[unit][i]];
+                if (0 == (value & (value - 1)))
+                {
+                    continue;
+                }
+
+                kept = value & ~solved;
+                only = kept & hidden;
+                if (0 != only)
+                {
+                    if (0 != (only & (only - 1)))
+                    {
+                        return 0;
+                    }
+                    kept = only;
+                }
+
+                if (kept != value)
+                {
+                    candidates[unit_cells[unit][i]] = kept;
+                    changed = 1;
+                }
+            }
+        }
+    }
+
+    return 1;
+}
+
+static void SearchScalar(const unsigned short *candidates, unsigned char *solution, unsigned int *solution_count, unsigned int limit)
+{
+    unsigned short state[SUDOKU_CELLS];
+    unsigned short choices = 0;
+    unsigned int best_count = BATCH_DIMENSION + 1;
+    unsigned int bits = 0;
+    size_t best_cell = SUDOKU_CELLS;
+    size_t cell = 0;
+
+    memcpy(state, candidates, sizeof(state));
+
+    if (!PropagateScalar(state))
+    {
+        return;
+    }
+
+    /* Branch on the cell with the fewest candidates */
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        bits = SudokuCountBits(state[cell]);
+        if ((1 < bits) && (bits < best_count))
+        {
+            best_count = bits;
+            best_cell = cell;
+        }
+    }
+
+    if (SUDOKU_CELLS == best_cell)
+    {
+        /* Entire board is filled, keep the first solution found */
+        if (0 == *solution_count)
+        {
+            WriteSolution(state, solution);
+        }
+        ++*solution_count;
+        return;
+    }
+
+    choices = state[best_cell];
+    while ((0 != choices) && (*solution_count < limit))
+    {
+        state[best_cell] = choices & (unsigned short)-choices;
+        choices &= (unsigned short)(choices - 1);
+
+        SearchScalar(state, solution, solution_count, limit);
+    }
+}
+
+static void WriteSolution(const unsigned short *candidates, unsigned char *solution)
+{
+    size_t cell = 0;
+    unsigned char digit = 0;
+    unsigned short value = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        value = candidates[cell];
+        for (digit = 1; 1 < value; ++digit)
+        {
+            value >>= 1;
+        }
+        solution[cell] = digit;
+    }
+}
+
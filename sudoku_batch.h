@@ -0,0 +1,60 @@
+/**
+ * @file sudoku_batch.h
+ * @brief Sudoku Batch Solver Interface
+ *
+ * This header file provides the interface for solving many puzzles
+ * at once. Candidate masks of SUDOKU_BATCH_LANES puzzles are laid out
+ * side by side (structure of arrays), so every propagation step is one
+ * vector operation over all lanes, compiled to SSE2, AVX2 or AVX-512
+ * instructions depending on the target flags (e.g. -O2 -march=native).
+ * Lanes that still need to branch after propagation are finished by a
+ * scalar solver.
+ *
+ * @author [Zayd Abu Sneineh]
+ */
+
+#ifndef SUDOKU_BATCH_H
+#define SUDOKU_BATCH_H
+
+#include <stddef.h> /* size_t */
+
+/**
+ * @def SUDOKU_BATCH_LANES
+ * Number of puzzles propagated together: one 16-bit lane per puzzle,
+ * as many lanes as fit in the widest vector register enabled.
+ */
+#if defined(__AVX512BW__)
+#define SUDOKU_BATCH_LANES 32
+#elif defined(__AVX2__)
+#define SUDOKU_BATCH_LANES 16
+#else
+#define SUDOKU_BATCH_LANES 8
+#endif
+
+/**
+ * @brief Solve many puzzles at once.
+ *
+ * @param puzzles count puzzles of 81 cells each, row-major, 0 for empty cells.
+ * @param solutions Receives count solutions of 81 cells each.
+ * @param solved Receives 1 for every puzzle that was solved and 0 for
+ *               every puzzle without a solution, including puzzles with
+ *               a cell above 9 (may be NULL).
+ * @param count Number of puzzles.
+ * @return Number of puzzles solved.
+ */
+size_t SolveSudokuBatch(const unsigned char *puzzles, unsigned char *solutions, unsigned char *solved, size_t count);
+
+/**
+ * @brief Solve a single puzzle with the scalar engine of the batch solver.
+ *
+ * This is the engine used for lanes that need to branch. It does not
+ * touch the game's global boards and is safe to call from many threads.
+ *
+ * @param puzzle 81 cells in row-major order, 0 for empty cells.
+ * @param solution Receives the first solution found (may be NULL).
+ * @param limit Stop searching after this many solutions.
+ * @return Number of solutions found, capped at limit; 0 if a cell is above 9.
+ */
+unsigned int SolveSudokuScalar(const unsigned char *puzzle, unsigned char *solution, unsigned int limit);
+
+#endif /* SUDOKU_BATCH_H */
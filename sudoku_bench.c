@@ -0,0 +1,833 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>    /* printf, fprintf, fopen, fgets, fclose */
+#include <stdlib.h>   /* EXIT_FAILURE, EXIT_SUCCESS, malloc, realloc, free, qsort, setenv, strtoul */
+#include <string.h>   /* strcmp, memcmp, strlen */
+#include <time.h>     /* clock_gettime, clock_getcpuclockid */
+#include <unistd.h>   /* read, write, close, execl, _exit */
+#include <poll.h>     /* poll */
+#include <signal.h>   /* kill, SIGKILL */
+#include <sys/wait.h> /* waitpid */
+#include <pty.h>      /* forkpty (link with -lutil) */
+
+#include "sudoku.h"
+#include "sudoku_batch.h"
+#include "sudoku_journal.h"
+
+#define BENCH_DEFAULT_COUNT 20000
+#define BENCH_GAME_ENGINE_SECONDS 5.0
+#define BENCH_PTY_GAME "./sudoku"
+#define BENCH_PTY_MENU "1\n1\n" /* Easy, classic rules */
+#define BENCH_PTY_ROUNDS 10
+#define BENCH_PTY_START_SECONDS 300.0 /* Generating a board without an archive can take a minute */
+#define BENCH_PTY_FRAME_SECONDS 5.0
+#define BENCH_PTY_IDLE_SECONDS 2.0
+#define BENCH_PTY_FRAME_MARKER "Press \"q\" to quit the game."
+#define BENCH_JOURNAL_FILE "bench.sdkj"
+#define BENCH_JOURNAL_EVENTS 200000
+#define BENCH_JOURNAL_RESUMES 1000
+/*  ==================================  */
+/*  ENUMERATIONS & TYPES                */
+/*  ==================================  */
+typedef struct Puzzle_Set
+{
+    unsigned char *cells;
+    size_t count;
+    size_t capacity;
+} puzzle_set_t;
+
+typedef struct Pty_Session
+{
+    int fd;
+    pid_t pid;
+    size_t matched; /* Characters of the frame marker matched so far */
+    size_t bytes;   /* Bytes read since the last reset */
+    int closed;
+} pty_session_t;
+
+/*  ==================================  */
+/*	Global Variables                    */
+/*  ==================================  */
+static const char *builtin_puzzles[] = {
+    "003020600900305001001806400008102900700000008006708200002609500800203009005010300",
+    "4.....8.5.3..........7......2.....6.....8.4......1.......6.3.7.5..2.....1.4......",
+    "85...24..72......9..4.........1.7..23.5...9...4...........8..7..17..........36.4.",
+    "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+    "..53.....8......2..7..1.5..4....53...1..7...6..32...8..6.5....9..4....3......97..",
+    "52...6.........7.13...........4..8..6......5...........418.........3..2...87.....",
+    "6.....8.3.4.7.................5.4.7.3..2.....1.6.......2.....5.....8.6......1....",
+    "48.3............71.2.......7.5....6....2..8.............1.76...3.....4......5....",
+    "....14....3....2...7..........9...3.6.1.............8.2.....1.4....5.6.....7.8..."};
+
+/* U, D, L and R stand for the arrow keys, every other character is sent as is */
+static const char *default_key_script = "RRDD5LU7h0RDD3hLLU9RRD1h0DDLL4s";
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static int RunBatchBenchmark(int argc, char **argv);
+static int RunNogoodBenchmark(int argc, char **argv);
+static int RunPtyBenchmark(int argc, char **argv);
+static int RunJournalBenchmark(int argc, char **argv);
+static void CountJournalEvent(const sudoku_journal_event_t *event, const sudoku_journal_state_t *state, void *context);
+static int IsSameSession(const sudoku_journal_state_t *first, const sudoku_journal_state_t *second);
+static int StartGame(pty_session_t *session, const char *game_path);
+static int SendKey(pty_session_t *session, char key);
+static int WaitForFrame(pty_session_t *session, double timeout);
+static void DrainOutput(pty_session_t *session, double seconds);
+static int StopGame(pty_session_t *session, double *quit_seconds);
+static double GetProcessCpuSeconds(pid_t pid);
+static int CompareDoubles(const void *first, const void *second);
+static double GetPercentile(const double *sorted, size_t count, double fraction);
+static int LoadPuzzles(const char *file_path, puzzle_set_t *set);
+static int AppendPuzzle(puzzle_set_t *set, const char *line);
+static void FillBuiltinPuzzles(puzzle_set_t *set, size_t count);
+static int IsValidSolution(const unsigned char *puzzle, const unsigned char *solution);
+static double GetSeconds();
+static void PrintUsage(const char *program);
+
+/*  =================================   */
+/*  Main                                */
+/*  =================================   */
+int main(int argc, char **argv)
+{
+    if ((2 <= argc) && (0 == strcmp(argv[1], "batch")))
+    {
+        return RunBatchBenchmark(argc - 2, argv + 2);
+    }
+    if ((2 <= argc) && (0 == strcmp(argv[1], "nogood")))
+    {
+        return RunNogoodBenchmark(argc - 2, argv + 2);
+    }
+    if ((2 <= argc) && (0 == strcmp(argv[1], "pty")))
+    {
+        return RunPtyBenchmark(argc - 2, argv + 2);
+    }
+    if ((2 <= argc) && (0 == strcmp(argv[1], "journal")))
+    {
+        return RunJournalBenchmark(argc - 2, argv + 2);
+    }
+
+    PrintUsage(argv[0]);
+
+    return EXIT_FAILURE;
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static int RunBatchBenchmark(int argc, char **argv)
+{
+    puzzle_set_t set = {NULL, 0, 0};
+    unsigned char *batch_solutions = NULL;
+    unsigned char *scalar_solutions = NULL;
+    unsigned char game_solution[SUDOKU_CELLS];
+    size_t batch_solved = 0;
+    size_t scalar_solved = 0;
+    size_t game_done = 0;
+    size_t mismatches = 0;
+    size_t i = 0;
+    double start = 0;
+    double batch_seconds = 0;
+    double scalar_seconds = 0;
+    double game_seconds = 0;
+
+    if (1 <= argc)
+    {
+        if (LoadPuzzles(argv[0], &set))
+        {
+            fprintf(stderr, "Cannot read puzzles from %s.\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        FillBuiltinPuzzles(&set, BENCH_DEFAULT_COUNT);
+    }
+
+    batch_solutions = (unsigned char *)malloc(set.count * SUDOKU_CELLS);
+    scalar_solutions = (unsigned char *)malloc(set.count * SUDOKU_CELLS);
+    if ((NULL == batch_solutions) || (NULL == scalar_solutions))
+    {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    start = GetSeconds();
+    batch_solved = SolveSudokuBatch(set.cells, batch_solutions, NULL, set.count);
+    batch_seconds = GetSeconds() - start;
+
+    start = GetSeconds();
+    for (i = 0; i < set.count; ++i)
+    {
+        scalar_solved += (0 != SolveSudokuScalar(set.cells + i * SUDOKU_CELLS, scalar_solutions + i * SUDOKU_CELLS, 1));
+    }
+    scalar_seconds = GetSeconds() - start;
+
+    /* The game engine is a plain backtracker, so it only gets a time budget */
+    start = GetSeconds();
+    while ((game_done < set.count) && (GetSeconds() - start < BENCH_GAME_ENGINE_SECONDS))
+    {
+        SolveSudokuPuzzle(set.cells + game_done * SUDOKU_CELLS, game_solution);
+        ++game_done;
+    }
+    game_seconds = GetSeconds() - start;
+
+    for (i = 0; i < set.count; ++i)
+    {
+        if ((!IsValidSolution(set.cells + i * SUDOKU_CELLS, batch_solutions + i * SUDOKU_CELLS)) ||
+            (0 != memcmp(batch_solutions + i * SUDOKU_CELLS, scalar_solutions + i * SUDOKU_CELLS, SUDOKU_CELLS)))
+        {
+            ++mismatches;
+        }
+    }
+
+    printf("puzzles        : %lu (%d lanes per block)\n", (unsigned long)set.count, SUDOKU_BATCH_LANES);
+    printf("batch engine   : %10.0f puzzles/sec, %lu solved\n", set.count / batch_seconds, (unsigned long)batch_solved);
+    printf("scalar engine  : %10.0f puzzles/sec, %lu solved\n", set.count / scalar_seconds, (unsigned long)scalar_solved);
+    printf("game engine    : %10.0f puzzles/sec, %lu puzzles in %.1f s\n", game_done / game_seconds,
+           (unsigned long)game_done, game_seconds);
+    printf("batch speedup  : %.2fx over scalar\n", scalar_seconds / batch_seconds);
+    printf("mismatches     : %lu\n", (unsigned long)mismatches);
+
+    free(set.cells);
+    free(batch_solutions);
+    free(scalar_solutions);
+
+    return (0 == mismatches) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int RunNogoodBenchmark(int argc, char **argv)
+{
+    puzzle_set_t set = {NULL, 0, 0};
+    unsigned char solution[SUDOKU_CELLS];
+    solver_stats_t plain;
+    solver_stats_t learning;
+    unsigned long plain_nodes = 0;
+    unsigned long learning_nodes = 0;
+    unsigned int plain_count = 0;
+    unsigned int learning_count = 0;
+    size_t mismatches = 0;
+    size_t i = 0;
+    double start = 0;
+    double plain_seconds = 0;
+    double learning_seconds = 0;
+
+    if (1 <= argc)
+    {
+        if (LoadPuzzles(argv[0], &set))
+        {
+            fprintf(stderr, "Cannot read puzzles from %s.\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        FillBuiltinPuzzles(&set, sizeof(builtin_puzzles) / sizeof(builtin_puzzles[0]));
+    }
+
+    printf("%-6s %14s %14s %10s %10s %10s\n", "puzzle", "plain nodes", "nogood nodes", "backjumps", "learned", "prunes");
+
+    for (i = 0; i < set.count; ++i)
+    {
+        start = GetSeconds();
+        plain_count = SolveSudokuPuzzleWithMode(set.cells + i * SUDOKU_CELLS, solution, PLAIN_BACKTRACKING, &plain);
+        plain_seconds += GetSeconds() - start;
+
+        start = GetSeconds();
+        learning_count = SolveSudokuPuzzleWithMode(set.cells + i * SUDOKU_CELLS, solution, NOGOOD_LEARNING, &learning);
+        learning_seconds += GetSeconds() - start;
+
+        mismatches += (plain_count != learning_count);
+        plain_nodes += plain.nodes;
+        learning_nodes += learning.nodes;
+
+        printf("%-6lu %14lu %14lu %10lu %10lu %10lu\n", (unsigned long)i, plain.nodes, learning.nodes,
+               learning.backjumps, learning.nogoods_learned, learning.nogood_prunes);
+    }
+
+    printf("total  %14lu %14lu  (%.2fx fewer nodes)\n", plain_nodes, learning_nodes,
+           (0 != learning_nodes) ? (double)plain_nodes / learning_nodes : 0.0);
+    printf("time   %13.3fs %13.3fs\n", plain_seconds, learning_seconds);
+    printf("mismatches     : %lu\n", (unsigned long)mismatches);
+
+    free(set.cells);
+
+    return (0 == mismatches) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int RunPtyBenchmark(int argc, char **argv)
+{
+    pty_session_t session;
+    const char *game_path = (1 <= argc) ? argv[0] : BENCH_PTY_GAME;
+    const char *key_script = (2 <= argc) ? argv[1] : default_key_script;
+    double start_timeout = (3 <= argc) ? strtod(argv[2], NULL) : BENCH_PTY_START_SECONDS;
+    size_t script_length = strlen(key_script);
+    size_t frame_count = 0;
+    size_t total_bytes = 0;
+    size_t min_bytes = (size_t)-1;
+    size_t max_bytes = 0;
+    size_t round = 0;
+    size_t i = 0;
+    double *latencies = NULL;
+    double start = 0;
+    double startup_seconds = 0;
+    double active_cpu = 0;
+    double active_seconds = 0;
+    double idle_cpu = 0;
+    double idle_seconds = 0;
+    double quit_seconds = 0;
+    int status = EXIT_SUCCESS;
+
+    if ((0 == script_length) || (0 >= start_timeout))
+    {
+        PrintUsage("sudoku_bench");
+        return EXIT_FAILURE;
+    }
+
+    latencies = (double *)malloc(BENCH_PTY_ROUNDS * script_length * sizeof(double));
+    if (NULL == latencies)
+    {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    start = GetSeconds();
+    if (StartGame(&session, game_path))
+    {
+        fprintf(stderr, "Cannot start %s on a pseudo-terminal.\n", game_path);
+        free(latencies);
+        return EXIT_FAILURE;
+    }
+
+    /* The level and rules are read with scanf before ncurses starts, the first frame follows */
+    if (((ssize_t)strlen(BENCH_PTY_MENU) == write(session.fd, BENCH_PTY_MENU, strlen(BENCH_PTY_MENU))) &&
+        (0 == WaitForFrame(&session, start_timeout)))
+    {
+        startup_seconds = GetSeconds() - start;
+
+        /* Every key redraws the whole grid; the frame is complete when its last line arrives */
+        active_cpu = GetProcessCpuSeconds(session.pid);
+        active_seconds = GetSeconds();
+        for (round = 0; (round < BENCH_PTY_ROUNDS) && (EXIT_SUCCESS == status); ++round)
+        {
+            for (i = 0; (i < script_length) && ('q' != key_script[i]); ++i)
+            {
+                session.bytes = 0;
+                start = GetSeconds();
+                if (SendKey(&session, key_script[i]) || WaitForFrame(&session, BENCH_PTY_FRAME_SECONDS))
+                {
+                    fprintf(stderr, "No frame after key '%c' (round %lu).\n", key_script[i], (unsigned long)round);
+                    status = EXIT_FAILURE;
+                    break;
+                }
+                latencies[frame_count++] = GetSeconds() - start;
+
+                total_bytes += session.bytes;
+                min_bytes = (session.bytes < min_bytes) ? session.bytes : min_bytes;
+                max_bytes = (session.bytes > max_bytes) ? session.bytes : max_bytes;
+            }
+        }
+        active_cpu = GetProcessCpuSeconds(session.pid) - active_cpu;
+        active_seconds = GetSeconds() - active_seconds;
+
+        /* With no input the game should sleep; anything it burns here is overhead */
+        idle_cpu = GetProcessCpuSeconds(session.pid);
+        idle_seconds = GetSeconds();
+        DrainOutput(&session, BENCH_PTY_IDLE_SECONDS);
+        idle_cpu = GetProcessCpuSeconds(session.pid) - idle_cpu;
+        idle_seconds = GetSeconds() - idle_seconds;
+    }
+    else
+    {
+        fprintf(stderr, "%s did not draw its first frame within %.0f s.\n", game_path, GetSeconds() - start);
+        status = EXIT_FAILURE;
+    }
+
+    if (StopGame(&session, &quit_seconds))
+    {
+        fprintf(stderr, "%s did not quit on 'q'.\n", game_path);
+        status = EXIT_FAILURE;
+    }
+
+    if (0 != frame_count)
+    {
+        qsort(latencies, frame_count, sizeof(double), CompareDoubles);
+
+        printf("frames         : %lu (%lu rounds of \"%s\")\n", (unsigned long)frame_count, (unsigned long)round,
+               key_script);
+        printf("startup        : %8.2f s to first frame, kept out of the latencies below\n", startup_seconds);
+        printf("key to frame   : p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+               GetPercentile(latencies, frame_count, 0.50) * 1e3, GetPercentile(latencies, frame_count, 0.90) * 1e3,
+               GetPercentile(latencies, frame_count, 0.99) * 1e3, latencies[frame_count - 1] * 1e3);
+        printf("bytes per frame: avg %lu, min %lu, max %lu\n", (unsigned long)(total_bytes / frame_count),
+               (unsigned long)min_bytes, (unsigned long)max_bytes);
+        printf("cpu while keyed: %6.1f%% of one core\n", (0 < active_seconds) ? 100 * active_cpu / active_seconds : 0.0);
+        printf("cpu while idle : %6.1f%% of one core\n", (0 < idle_seconds) ? 100 * idle_cpu / idle_seconds : 0.0);
+        printf("quit           : %8.2f ms from 'q' to exit\n", quit_seconds * 1e3);
+    }
+
+    free(latencies);
+
+    return status;
+}
+
+static int RunJournalBenchmark(int argc, char **argv)
+{
+    sudoku_journal_state_t expected;
+    sudoku_journal_state_t loaded;
+    sudoku_journal_t *journal = NULL;
+    unsigned long events = (1 <= argc) ? strtoul(argv[0], NULL, 10) : BENCH_JOURNAL_EVENTS;
+    unsigned long replay_counts[2] = {0, 0}; /* Events, snapshots */
+    unsigned long random_state = 1;
+    unsigned long i = 0;
+    unsigned int cell = 0;
+    unsigned int digit = 0;
+    double resume_seconds[BENCH_JOURNAL_RESUMES];
+    double start = 0;
+    double write_seconds = 0;
+    double replay_seconds = 0;
+    long file_size = 0;
+    long replayed = 0;
+    size_t mismatches = 0;
+    size_t resume = 0;
+    unsigned char torn[2] = {JOURNAL_SET_CELL, 0};
+    FILE *file = NULL;
+
+    memset(&expected, 0, sizeof(expected));
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        expected.givens[cell] = ('.' == builtin_puzzles[0][cell]) ? 0 : (unsigned char)(builtin_puzzles[0][cell] - '0');
+    }
+    memcpy(expected.board, expected.givens, SUDOKU_CELLS);
+    SolveSudokuPuzzle(expected.givens, expected.solution);
+
+    /* A deterministic session: cursor moves, digits and clears outside the givens, flushed per key like the game */
+    journal = SudokuJournalCreate(BENCH_JOURNAL_FILE, &expected);
+    if (NULL == journal)
+    {
+        fprintf(stderr, "Cannot create %s.\n", BENCH_JOURNAL_FILE);
+        return EXIT_FAILURE;
+    }
+
+    start = GetSeconds();
+    for (i = 0; i < events; ++i)
+    {
+        random_state = random_state * 6364136223846793005UL + 1442695040888963407UL;
+        cell = (unsigned int)((random_state >> 33) % SUDOKU_CELLS);
+        digit = (unsigned int)(1 + (random_state >> 45) % 9);
+
+        if ((0 == ((random_state >> 60) & 1)) || (0 != expected.givens[cell]))
+        {
+            expected.cursor = cell;
+            SudokuJournalMoveCursor(journal, cell);
+        }
+        else if (0 == ((random_state >> 61) & 1))
+        {
+            expected.board[cell] = (unsigned char)digit;
+            SudokuJournalSetCell(journal, cell, digit);
+        }
+        else
+        {
+            expected.board[cell] = 0;
+            SudokuJournalClearCell(journal, cell);
+        }
+        SudokuJournalFlush(journal);
+    }
+    mismatches += (0 != SudokuJournalClose(journal));
+    write_seconds = GetSeconds() - start;
+
+    file = fopen(BENCH_JOURNAL_FILE, "rb");
+    if (NULL != file)
+    {
+        fseek(file, 0, SEEK_END);
+        file_size = ftell(file);
+        fclose(file);
+    }
+
+    for (resume = 0; resume < BENCH_JOURNAL_RESUMES; ++resume)
+    {
+        start = GetSeconds();
+        mismatches += (0 != SudokuJournalLoad(BENCH_JOURNAL_FILE, &loaded));
+        resume_seconds[resume] = GetSeconds() - start;
+        mismatches += !IsSameSession(&loaded, &expected);
+    }
+    qsort(resume_seconds, BENCH_JOURNAL_RESUMES, sizeof(resume_seconds[0]), CompareDoubles);
+
+    start = GetSeconds();
+    replayed = SudokuJournalReplay(BENCH_JOURNAL_FILE, &loaded, CountJournalEvent, replay_counts);
+    replay_seconds = GetSeconds() - start;
+    mismatches += ((long)(events + replay_counts[1]) != replayed) || (events != replay_counts[0]);
+    mismatches += !IsSameSession(&loaded, &expected);
+
+    /* A record cut short by a crash is ignored, and dropped when the journal is resumed */
+    file = fopen(BENCH_JOURNAL_FILE, "ab");
+    if (NULL != file)
+    {
+        fwrite(torn, 1, sizeof(torn), file);
+        fclose(file);
+    }
+    mismatches += (0 != SudokuJournalLoad(BENCH_JOURNAL_FILE, &loaded)) || !IsSameSession(&loaded, &expected);
+
+    journal = SudokuJournalResume(BENCH_JOURNAL_FILE, &loaded);
+    if (NULL == journal)
+    {
+        ++mismatches;
+    }
+    else
+    {
+        mismatches += !IsSameSession(&loaded, &expected);
+        expected.cursor = (expected.cursor + 1) % SUDOKU_CELLS;
+        SudokuJournalMoveCursor(journal, expected.cursor);
+        mismatches += (0 != SudokuJournalClose(journal));
+        mismatches += (0 > SudokuJournalReplay(BENCH_JOURNAL_FILE, &loaded, NULL, NULL)) ||
+                      !IsSameSession(&loaded, &expected);
+    }
+
+    remove(BENCH_JOURNAL_FILE);
+
+    printf("events         : %lu (%.2f bytes each, %ld bytes with %lu snapshots)\n", events,
+           (0 != events) ? (double)file_size / events : 0.0, file_size, replay_counts[1]);
+    printf("record         : %.2f us per event, flushed per event\n", 1e6 * write_seconds / (0 != events ? events : 1));
+    printf("resume         : p50 %.1f us, p99 %.1f us, max %.1f us\n",
+           1e6 * GetPercentile(resume_seconds, BENCH_JOURNAL_RESUMES, 0.5),
+           1e6 * GetPercentile(resume_seconds, BENCH_JOURNAL_RESUMES, 0.99),
+           1e6 * resume_seconds[BENCH_JOURNAL_RESUMES - 1]);
+    printf("full replay    : %.3f ms (%.1f M events/sec)\n", 1e3 * replay_seconds,
+           (0 < replay_seconds) ? replayed / replay_seconds / 1e6 : 0.0);
+    printf("mismatches     : %lu\n", (unsigned long)mismatches);
+
+    return (0 == mismatches) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void CountJournalEvent(const sudoku_journal_event_t *event, const sudoku_journal_state_t *state, void *context)
+{
+    unsigned long *counts = (unsigned long *)context;
+
+    (void)state;
+    ++counts[(JOURNAL_SNAPSHOT == event->type) ? 1 : 0];
+}
+
+static int IsSameSession(const sudoku_journal_state_t *first, const sudoku_journal_state_t *second)
+{
+    return (first->rules == second->rules) && (first->cursor == second->cursor) &&
+           (0 == memcmp(first->givens, second->givens, SUDOKU_CELLS)) &&
+           (0 == memcmp(first->board, second->board, SUDOKU_CELLS)) &&
+           (0 == memcmp(first->solution, second->solution, SUDOKU_CELLS));
+}
+
+static int StartGame(pty_session_t *session, const char *game_path)
+{
+    struct winsize size = {40, 100, 0, 0};
+
+    session->matched = 0;
+    session->bytes = 0;
+    session->closed = 0;
+
+    session->pid = forkpty(&session->fd, NULL, NULL, &size);
+    if (-1 == session->pid)
+    {
+        return 1;
+    }
+
+    if (0 == session->pid)
+    {
+        setenv("TERM", "xterm", 1);
+        execl(game_path, game_path, (char *)NULL);
+        _exit(127);
+    }
+
+    return 0;
+}
+
+static int SendKey(pty_session_t *session, char key)
+{
+    const char *sequence = NULL;
+    size_t length = 0;
+
+    /* keypad() switches the terminal to application mode, where xterm sends ESC O x */
+    switch (key)
+    {
+    case 'U':
+        sequence = "\033OA";
+        break;
+    case 'D':
+        sequence = "\033OB";
+        break;
+    case 'R':
+        sequence = "\033OC";
+        break;
+    case 'L':
+        sequence = "\033OD";
+        break;
+    default:
+        sequence = NULL;
+        break;
+    }
+
+    if (NULL == sequence)
+    {
+        return (1 != write(session->fd, &key, 1));
+    }
+
+    length = strlen(sequence);
+
+    return ((ssize_t)length != write(session->fd, sequence, length));
+}
+
+static int WaitForFrame(pty_session_t *session, double timeout)
+{
+    static const char marker[] = BENCH_PTY_FRAME_MARKER;
+    char buffer[4096];
+    struct pollfd poll_fd;
+    double deadline = GetSeconds() + timeout;
+    double remaining = timeout;
+    ssize_t length = 0;
+    ssize_t i = 0;
+
+    poll_fd.fd = session->fd;
+    poll_fd.events = POLLIN;
+
+    while ((!session->closed) && (0 < (remaining = deadline - GetSeconds())))
+    {
+        if (0 >= poll(&poll_fd, 1, (int)(remaining * 1e3) + 1))
+        {
+            continue;
+        }
+
+        length = read(session->fd, buffer, sizeof(buffer));
+        if (0 >= length)
+        {
+            session->closed = 1;
+            break;
+        }
+
+        for (i = 0; i < length; ++i)
+        {
+            if (buffer[i] == marker[session->matched])
+            {
+                ++session->matched;
+            }
+            else
+            {
+                session->matched = (buffer[i] == marker[0]);
+            }
+
+            if (sizeof(marker) - 1 == session->matched)
+            {
+                session->matched = 0;
+                session->bytes += (size_t)length;
+
+                return 0;
+            }
+        }
+
+        session->bytes += (size_t)length;
+    }
+
+    return 1;
+}
+
+static void DrainOutput(pty_session_t *session, double seconds)
+{
+    char buffer[4096];
+    struct pollfd poll_fd;
+    double deadline = GetSeconds() + seconds;
+    double remaining = seconds;
+
+    poll_fd.fd = session->fd;
+    poll_fd.events = POLLIN;
+
+    while ((!session->closed) && (0 < (remaining = deadline - GetSeconds())))
+    {
+        if ((0 < poll(&poll_fd, 1, (int)(remaining * 1e3) + 1)) && (0 >= read(session->fd, buffer, sizeof(buffer))))
+        {
+            session->closed = 1;
+        }
+    }
+}
+
+static int StopGame(pty_session_t *session, double *quit_seconds)
+{
+    double start = GetSeconds();
+    int exited = 0;
+
+    if (!session->closed)
+    {
+        exited = (1 != write(session->fd, "q", 1));
+    }
+
+    /* Keep reading so the game never blocks on a full terminal while shutting down */
+    while ((!exited) && (GetSeconds() - start < BENCH_PTY_FRAME_SECONDS))
+    {
+        if (session->pid == waitpid(session->pid, NULL, WNOHANG))
+        {
+            *quit_seconds = GetSeconds() - start;
+            close(session->fd);
+
+            return 0;
+        }
+        DrainOutput(session, 0.001);
+    }
+
+    kill(session->pid, SIGKILL);
+    waitpid(session->pid, NULL, 0);
+    close(session->fd);
+
+    return 1;
+}
+
+static double GetProcessCpuSeconds(pid_t pid)
+{
+    struct timespec now;
+    clockid_t clock_id;
+
+    if ((0 != clock_getcpuclockid(pid, &clock_id)) || (0 != clock_gettime(clock_id, &now)))
+    {
+        return 0;
+    }
+
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static int CompareDoubles(const void *first, const void *second)
+{
+    double difference = *(const double *)first - *(const double *)second;
+
+    return (0 < difference) - (0 > difference);
+}
+
+static double GetPercentile(const double *sorted, size_t count, double fraction)
+{
+    return sorted[(size_t)(fraction * (count - 1) + 0.5)];
+}
+
+static int LoadPuzzles(const char *file_path, puzzle_set_t *set)
+{
+    char line[256];
+    FILE *file = fopen(file_path, "r");
+
+    if (NULL == file)
+    {
+        return 1;
+    }
+
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        if (AppendPuzzle(set, line))
+        {
+            fclose(file);
+            return 1;
+        }
+    }
+
+    fclose(file);
+
+    return (0 == set->count);
+}
+
+static int AppendPuzzle(puzzle_set_t *set, const char *line)
+{
+    unsigned char *cells = NULL;
+    size_t cell = 0;
+
+    /* Lines that are not 81 cells long (comments, blank lines) are skipped */
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (('.' != line[cell]) && (('0' > line[cell]) || ('9' < line[cell])))
+        {
+            return 0;
+        }
+    }
+
+    if (set->count == set->capacity)
+    {
+        cells = (unsigned char *)realloc(set->cells, (2 * set->capacity + 1) * SUDOKU_CELLS);
+        if (NULL == cells)
+        {
+            return 1;
+        }
+        set->cells = cells;
+        set->capacity = 2 * set->capacity + 1;
+    }
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        set->cells[set->count * SUDOKU_CELLS + cell] = ('.' == line[cell]) ? 0 : (unsigned char)(line[cell] - '0');
+    }
+    ++set->count;
+
+    return 0;
+}
+
+static void FillBuiltinPuzzles(puzzle_set_t *set, size_t count)
+{
+    size_t builtin_count = sizeof(builtin_puzzles) / sizeof(builtin_puzzles[0]);
+    size_t i = 0;
+
+    for (i = 0; i < count; ++i)
+    {
+        if (AppendPuzzle(set, builtin_puzzles[i % builtin_count]))
+        {
+            fprintf(stderr, "Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static int IsValidSolution(const unsigned char *puzzle, const unsigned char *solution)
+{
+    unsigned int row_seen[9] = {0};
+    unsigned int col_seen[9] = {0};
+    unsigned int box_seen[9] = {0};
+    unsigned int bit = 0;
+    size_t cell = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if ((0 == solution[cell]) || (9 < solution[cell]) || ((0 != puzzle[cell]) && (puzzle[cell] != solution[cell])))
+        {
+            return 0;
+        }
+
+        bit = 1u << solution[cell];
+        if ((row_seen[cell / 9] & bit) || (col_seen[cell % 9] & bit) || (box_seen[(cell / 27) * 3 + (cell % 9) / 3] & bit))
+        {
+            return 0;
+        }
+
+        row_seen[cell / 9] |= bit;
+        col_seen[cell % 9] |= bit;
+        box_seen[(cell / 27) * 3 + (cell % 9) / 3] |= bit;
+    }
+
+    return 1;
+}
+
+static double GetSeconds()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static void PrintUsage(const char *program)
+{
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s batch [puzzle-file]   Batch solver vs. single-puzzle engines\n", program);
+    fprintf(stderr, "  %s nogood [puzzle-file]  Nogood learning vs. plain backtracking node counts\n", program);
+    fprintf(stderr, "  %s pty [game] [keys] [start-seconds]\n", program);
+    fprintf(stderr, "                           Keystroke-to-frame latency of the game on a pseudo-terminal\n");
+    fprintf(stderr, "                           (keys: U/D/L/R for arrows, others sent as is; default %s;\n",
+            default_key_script);
+    fprintf(stderr, "                           start-seconds bounds board generation, default %.0f)\n",
+            BENCH_PTY_START_SECONDS);
+    fprintf(stderr, "  %s journal [events]      Session journal record, resume and replay speed\n", program);
+}
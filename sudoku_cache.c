@@ -0,0 +1,572 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#include <stdio.h>   /* FILE, fopen, fread, fwrite, fseek, ftell, fclose, rename, remove */
+#include <stdlib.h>  /* malloc, calloc, free */
+#include <string.h>  /* memcmp, memcpy, strlen */
+#include <stdint.h>  /* uint32_t */
+#include <pthread.h> /* pthread_mutex_t, pthread_mutex_lock, pthread_mutex_unlock */
+
+#include "sudoku.h"
+#include "sudoku_cache.h"
+#include "sudoku_util.h"
+
+#define CACHE_SHARDS 8
+#define CACHE_PACKED_SIZE ((SUDOKU_CELLS + 1) / 2)
+#define CACHE_FILE_MAGIC "SDKC"
+#define CACHE_FILE_VERSION 2
+#define CACHE_FILE_HEADER_SIZE 16                     /* Magic, version, entry count, checksum of the entries */
+#define CACHE_RECORD_SIZE (2 * CACHE_PACKED_SIZE + 1) /* Puzzle, solution, solution count */
+/*  ==================================  */
+/*  ENUMERATIONS & TYPES                */
+/*  ==================================  */
+typedef struct Cache_Entry
+{
+    unsigned long long hash;
+    unsigned char puzzle[CACHE_PACKED_SIZE];
+    unsigned char solution[CACHE_PACKED_SIZE];
+    unsigned int solution_count;
+    struct Cache_Entry *prev;  /* Towards the most recently used entry */
+    struct Cache_Entry *next;  /* Towards the least recently used entry */
+    struct Cache_Entry *chain; /* Next entry in the same bucket */
+} cache_entry_t;
+
+typedef struct Cache_Shard
+{
+    pthread_mutex_t lock;
+    cache_entry_t *pool;
+    cache_entry_t **buckets;
+    size_t bucket_count;
+    size_t capacity;
+    size_t used;
+    cache_entry_t *head; /* Most recently used */
+    cache_entry_t *tail; /* Least recently used */
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} cache_shard_t;
+
+struct Sudoku_Cache
+{
+    cache_shard_t shards[CACHE_SHARDS];
+    char *file_path;
+};
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static void PackCells(const unsigned char *cells, unsigned char *packed);
+static void UnpackCells(const unsigned char *packed, unsigned char *cells);
+static cache_shard_t *GetShard(sudoku_cache_t *cache, unsigned long long hash);
+static cache_entry_t *FindEntry(cache_shard_t *shard, unsigned long long hash, const unsigned char *packed_puzzle);
+static void UnlinkEntry(cache_shard_t *shard, cache_entry_t *entry);
+static void PushFront(cache_shard_t *shard, cache_entry_t *entry);
+static void RemoveFromBucket(cache_shard_t *shard, cache_entry_t *entry);
+static void InsertPacked(sudoku_cache_t *cache, unsigned long long hash, const unsigned char *packed_puzzle,
+                         const unsigned char *packed_solution, unsigned int solution_count);
+static void LoadCacheFile(sudoku_cache_t *cache);
+static int IsValidRecord(const unsigned char *record);
+
+/*  =================================   */
+/*  API Functions Implementation        */
+/*  =================================   */
+sudoku_cache_t *SudokuCacheCreate(size_t capacity, const char *file_path)
+{
+    size_t i = 0;
+    size_t shard_capacity = 0;
+    cache_shard_t *shard = NULL;
+
+    sudoku_cache_t *cache = (sudoku_cache_t *)calloc(1, sizeof(sudoku_cache_t));
+    if (NULL == cache)
+    {
+        return NULL;
+    }
+
+    shard_capacity = (capacity + CACHE_SHARDS - 1) / CACHE_SHARDS;
+    if (0 == shard_capacity)
+    {
+        shard_capacity = 1;
+    }
+
+    /* Every lock exists before anything can fail, so SudokuCacheDestroy may destroy them all */
+    for (i = 0; i < CACHE_SHARDS; ++i)
+    {
+        pthread_mutex_init(&cache->shards[i].lock, NULL);
+    }
+
+    for (i = 0; i < CACHE_SHARDS; ++i)
+    {
+        shard = &cache->shards[i];
+
+        shard->capacity = shard_capacity;
+
+        /* Keep the bucket count a power of two so the hash can be masked */
+        shard->bucket_count = 1;
+        while (shard->bucket_count < shard_capacity)
+        {
+            shard->bucket_count <<= 1;
+        }
+
+        shard->pool = (cache_entry_t *)calloc(shard_capacity, sizeof(cache_entry_t));
+        shard->buckets = (cache_entry_t **)calloc(shard->bucket_count, sizeof(cache_entry_t *));
+        if ((NULL == shard->pool) || (NULL == shard->buckets))
+        {
+            cache->file_path = NULL;
+            SudokuCacheDestroy(cache);
+            return NULL;
+        }
+    }
+
+    if (NULL != file_path)
+    {
+        cache->file_path = (char *)malloc(strlen(file_path) + 1);
+        if (NULL == cache->file_path)
+        {
+            SudokuCacheDestroy(cache);
+            return NULL;
+        }
+        memcpy(cache->file_path, file_path, strlen(file_path) + 1);
+
+        LoadCacheFile(cache);
+    }
+
+    return cache;
+}
+
+void SudokuCacheDestroy(sudoku_cache_t *cache)
+{
+    size_t i = 0;
+
+    if (NULL == cache)
+    {
+        return;
+    }
+
+    SudokuCacheSave(cache);
+
+    for (i = 0; i < CACHE_SHARDS; ++i)
+    {
+        pthread_mutex_destroy(&cache->shards[i].lock);
+        free(cache->shards[i].pool);
+        free(cache->shards[i].buckets);
+    }
+
+    free(cache->file_path);
+    free(cache);
+}
+
+int SudokuCacheLookup(sudoku_cache_t *cache, const unsigned char *puzzle,
+                      unsigned char *solution, unsigned int *solution_count)
+{
+    unsigned char packed_puzzle[CACHE_PACKED_SIZE];
+    unsigned long long hash = SudokuHashPuzzle(puzzle);
+    cache_shard_t *shard = GetShard(cache, hash);
+    cache_entry_t *entry = NULL;
+
+    PackCells(puzzle, packed_puzzle);
+
+    pthread_mutex_lock(&shard->lock);
+
+    entry = FindEntry(shard, hash, packed_puzzle);
+    if (NULL == entry)
+    {
+        ++shard->misses;
+        pthread_mutex_unlock(&shard->lock);
+        return 0;
+    }
+
+    ++shard->hits;
+
+    /* Move the entry to the front of the LRU list */
+    UnlinkEntry(shard, entry);
+    PushFront(shard, entry);
+
+    if (NULL != solution)
+    {
+        UnpackCells(entry->solution, solution);
+    }
+    if (NULL != solution_count)
+    {
+        *solution_count = entry->solution_count;
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+
+    return 1;
+}
+
+void SudokuCacheInsert(sudoku_cache_t *cache, const unsigned char *puzzle,
+                       const unsigned char *solution, unsigned int solution_count)
+{
+    unsigned char packed_puzzle[CACHE_PACKED_SIZE];
+    unsigned char packed_solution[CACHE_PACKED_SIZE];
+
+    PackCells(puzzle, packed_puzzle);
+    PackCells(solution, packed_solution);
+
+    InsertPacked(cache, SudokuHashPuzzle(puzzle), packed_puzzle, packed_solution, solution_count);
+}
+
+int SudokuCacheSave(sudoku_cache_t *cache)
+{
+    FILE *file = NULL;
+    char *temp_path = NULL;
+    unsigned char header[CACHE_FILE_HEADER_SIZE];
+    unsigned char *records = NULL;
+    unsigned char *record = NULL;
+    size_t i = 0;
+    size_t count = 0;
+    cache_entry_t *entry = NULL;
+    int failed = 0;
+
+    if (NULL == cache->file_path)
+    {
+        return 0;
+    }
+
+    temp_path = (char *)malloc(strlen(cache->file_path) + sizeof(".tmp"));
+    if (NULL == temp_path)
+    {
+        return 1;
+    }
+    memcpy(temp_path, cache->file_path, strlen(cache->file_path));
+    memcpy(temp_path + strlen(cache->file_path), ".tmp", sizeof(".tmp"));
+
+    file = fopen(temp_path, "wb");
+    if (NULL == file)
+    {
+        free(temp_path);
+        return 1;
+    }
+
+    for (i = 0; i < CACHE_SHARDS; ++i)
+    {
+        pthread_mutex_lock(&cache->shards[i].lock);
+        count += cache->shards[i].used;
+    }
+
+    /* Least recently used entries first, so loading restores the LRU order */
+    records = (unsigned char *)malloc(count * CACHE_RECORD_SIZE + 1);
+    for (i = 0, record = records; (i < CACHE_SHARDS) && (NULL != records); ++i)
+    {
+        for (entry = cache->shards[i].tail; NULL != entry; entry = entry->prev, record += CACHE_RECORD_SIZE)
+        {
+            memcpy(record, entry->puzzle, CACHE_PACKED_SIZE);
+            memcpy(record + CACHE_PACKED_SIZE, entry->solution, CACHE_PACKED_SIZE);
+            record[2 * CACHE_PACKED_SIZE] = (unsigned char)entry->solution_count;
+        }
+    }
+
+    for (i = 0; i < CACHE_SHARDS; ++i)
+    {
+        pthread_mutex_unlock(&cache->shards[i].lock);
+    }
+
+    if (NULL == records)
+    {
+        fclose(file);
+        remove(temp_path);
+        free(temp_path);
+        return 1;
+    }
+
+    memcpy(header, CACHE_FILE_MAGIC, 4);
+    SudokuPutUInt32(header + 4, CACHE_FILE_VERSION);
+    SudokuPutUInt32(header + 8, (uint32_t)count);
+    SudokuPutUInt32(header + 12, SudokuChecksum(records, count * CACHE_RECORD_SIZE));
+
+    fwrite(header, 1, CACHE_FILE_HEADER_SIZE, file);
+    fwrite(records, CACHE_RECORD_SIZE, count, file);
+    free(records);
+
+    failed = ferror(file);
+    failed |= fclose(file);
+
+    if (failed || (0 != rename(temp_path, cache->file_path)))
+    {
+        remove(temp_path);
+        free(temp_path);
+        return 1;
+    }
+
+    free(temp_path);
+
+    return 0;
+}
+
+void SudokuCacheGetStats(sudoku_cache_t *cache, sudoku_cache_stats_t *stats)
+{
+    size_t i = 0;
+
+    stats->hits = 0;
+    stats->misses = 0;
+    stats->evictions = 0;
+    stats->entries = 0;
+    stats->capacity = 0;
+
+    for (i = 0; i < CACHE_SHARDS; ++i)
+    {
+        pthread_mutex_lock(&cache->shards[i].lock);
+
+        stats->hits += cache->shards[i].hits;
+        stats->misses += cache->shards[i].misses;
+        stats->evictions += cache->shards[i].evictions;
+        stats->entries += cache->shards[i].used;
+        stats->capacity += cache->shards[i].capacity;
+
+        pthread_mutex_unlock(&cache->shards[i].lock);
+    }
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static void PackCells(const unsigned char *cells, unsigned char *packed)
+{
+    size_t cell = 0;
+
+    for (cell = 0; cell < CACHE_PACKED_SIZE; ++cell)
+    {
+        packed[cell] = 0;
+    }
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        packed[cell / 2] |= (unsigned char)((cells[cell] & 0x0F) << ((cell % 2) * 4));
+    }
+}
+
+static void UnpackCells(const unsigned char *packed, unsigned char *cells)
+{
+    size_t cell = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        cells[cell] = (packed[cell / 2] >> ((cell % 2) * 4)) & 0x0F;
+    }
+}
+
+static cache_shard_t *GetShard(sudoku_cache_t *cache, unsigned long long hash)
+{
+    /* The top bits pick the shard, the low bits pick the bucket */
+    return &cache->shards[(hash >> 59) % CACHE_SHARDS];
+}
+
+static cache_entry_t *FindEntry(cache_shard_t *shard, unsigned long long hash, const unsigned char *packed_puzzle)
+{
+    cache_entry_t *entry = shard->buckets[hash & (shard->bucket_count - 1)];
+
+    while (NULL != entry)
+    {
+        if ((hash == entry->hash) && (0 == memcmp(entry->puzzle, packed_puzzle, CACHE_PACKED_SIZE)))
+        {
+            return entry;
+        }
+        entry = entry->chain;
+    }
+
+    return NULL;
+}
+
+static void UnlinkEntry(cache_shard_t *shard, cache_entry_t *entry)
+{
+    if (NULL != entry->prev)
+    {
+        entry->prev->next = entry->next;
+    }
+    else
+    {
+        shard->head = entry->next;
+    }
+
+    if (NULL != entry->next)
+    {
+        entry->next->prev = entry->prev;
+    }
+    else
+    {
+        shard->tail = entry->prev;
+    }
+
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void PushFront(cache_shard_t *shard, cache_entry_t *entry)
+{
+    entry->prev = NULL;
+    entry->next = shard->head;
+
+    if (NULL != shard->head)
+    {
+        shard->head->prev = entry;
+    }
+    shard->head = entry;
+
+    if (NULL == shard->tail)
+    {
+        shard->tail = entry;
+    }
+}
+
+static void RemoveFromBucket(cache_shard_t *shard, cache_entry_t *entry)
+{
+    cache_entry_t **link = &shard->buckets[entry->hash & (shard->bucket_count - 1)];
+
+    while (entry != *link)
+    {
+        link = &(*link)->chain;
+    }
+
+    *link = entry->chain;
+    entry->chain = NULL;
+}
+
+static void InsertPacked(sudoku_cache_t *cache, unsigned long long hash, const unsigned char *packed_puzzle,
+                         const unsigned char *packed_solution, unsigned int solution_count)
+{
+    cache_shard_t *shard = GetShard(cache, hash);
+    cache_entry_t *entry = NULL;
+    size_t bucket = 0;
+
+    pthread_mutex_lock(&shard->lock);
+
+    entry = FindEntry(shard, hash, packed_puzzle);
+    if (NULL != entry)
+    {
+        UnlinkEntry(shard, entry);
+    }
+    else
+    {
+        if (shard->used < shard->capacity)
+        {
+            entry = &shard->pool[shard->used++];
+        }
+        else
+        {
+            /* Recycle the least recently used entry */
+            entry = shard->tail;
+            UnlinkEntry(shard, entry);
+            RemoveFromBucket(shard, entry);
+            ++shard->evictions;
+        }
+
+        entry->hash = hash;
+        memcpy(entry->puzzle, packed_puzzle, CACHE_PACKED_SIZE);
+
+        bucket = hash & (shard->bucket_count - 1);
+        entry->chain = shard->buckets[bucket];
+        shard->buckets[bucket] = entry;
+    }
+
+    memcpy(entry->solution, packed_solution, CACHE_PACKED_SIZE);
+    entry->solution_count = solution_count;
+    PushFront(shard, entry);
+
+    pthread_mutex_unlock(&shard->lock);
+}
+
+static void LoadCacheFile(sudoku_cache_t *cache)
+{
+    FILE *file = NULL;
+    unsigned char header[CACHE_FILE_HEADER_SIZE];
+    unsigned char *records = NULL;
+    unsigned char *record = NULL;
+    unsigned char puzzle[SUDOKU_CELLS];
+    unsigned long count = 0;
+    unsigned long i = 0;
+    long size = 0;
+
+    file = fopen(cache->file_path, "rb");
+    if (NULL == file)
+    {
+        return;
+    }
+
+    if ((CACHE_FILE_HEADER_SIZE != fread(header, 1, CACHE_FILE_HEADER_SIZE, file)) ||
+        (0 != memcmp(header, CACHE_FILE_MAGIC, 4)) || (CACHE_FILE_VERSION != SudokuGetUInt32(header + 4)) ||
+        (0 != fseek(file, 0, SEEK_END)) || (0 > (size = ftell(file))))
+    {
+        fclose(file);
+        return;
+    }
+
+    /* The file must hold exactly the entries it announces, which also bounds the allocation */
+    count = SudokuGetUInt32(header + 8);
+    if ((unsigned long)size - CACHE_FILE_HEADER_SIZE != count * CACHE_RECORD_SIZE)
+    {
+        fclose(file);
+        return;
+    }
+
+    records = (unsigned char *)malloc(count * CACHE_RECORD_SIZE + 1);
+    if ((NULL == records) || (0 != fseek(file, CACHE_FILE_HEADER_SIZE, SEEK_SET)) ||
+        (count != fread(records, CACHE_RECORD_SIZE, count, file)) ||
+        (SudokuGetUInt32(header + 12) != SudokuChecksum(records, count * CACHE_RECORD_SIZE)))
+    {
+        free(records);
+        fclose(file);
+        return;
+    }
+    fclose(file);
+
+    /* A wrong solution would be shown without searching, so one bad entry discards the whole file */
+    for (i = 0; i < count; ++i)
+    {
+        if (!IsValidRecord(records + i * CACHE_RECORD_SIZE))
+        {
+            free(records);
+            return;
+        }
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        record = records + i * CACHE_RECORD_SIZE;
+        UnpackCells(record, puzzle);
+        InsertPacked(cache, SudokuHashPuzzle(puzzle), record, record + CACHE_PACKED_SIZE,
+                     record[2 * CACHE_PACKED_SIZE]);
+    }
+
+    free(records);
+}
+
+static int IsValidRecord(const unsigned char *record)
+{
+    unsigned char puzzle[SUDOKU_CELLS];
+    unsigned char solution[SUDOKU_CELLS];
+    unsigned int solution_count = record[2 * CACHE_PACKED_SIZE];
+    size_t cell = 0;
+
+    UnpackCells(record, puzzle);
+    UnpackCells(record + CACHE_PACKED_SIZE, solution);
+
+    if (2 < solution_count)
+    {
+        return 0;
+    }
+
+    /* A solved entry keeps a complete grid that agrees with every clue; an unsolvable one keeps the puzzle */
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if ((9 < puzzle[cell]) || (9 < solution[cell]))
+        {
+            return 0;
+        }
+        if (0 == solution_count)
+        {
+            if (puzzle[cell] != solution[cell])
+            {
+                return 0;
+            }
+        }
+        else if ((0 == solution[cell]) || ((0 != puzzle[cell]) && (puzzle[cell] != solution[cell])))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
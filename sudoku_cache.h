@@ -0,0 +1,87 @@
+/**
+ * @file sudoku_cache.h
+ * @brief Sudoku Solution Cache Interface
+ *
+ * This header file provides the interface for a bounded LRU cache
+ * that maps a puzzle to its solution and solution count. Lookups
+ * are keyed by a hash of the puzzle cells, entries are stored packed
+ * (two cells per byte), and the cache may be backed by a file so it
+ * survives restarts. The cache is safe to use from several threads.
+ *
+ * @author [Zayd Abu Sneineh]
+ */
+
+#ifndef SUDOKU_CACHE_H
+#define SUDOKU_CACHE_H
+
+#include <stddef.h> /* size_t */
+
+/**
+ * @typedef sudoku_cache_t
+ * Typedef for the solution cache structure.
+ * The structure is defined in the implementation file.
+ */
+typedef struct Sudoku_Cache sudoku_cache_t;
+
+/**
+ * @struct Sudoku_Cache_Stats
+ * Counters used to tune the cache capacity.
+ */
+typedef struct Sudoku_Cache_Stats
+{
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t entries;
+    size_t capacity;
+} sudoku_cache_stats_t;
+
+/**
+ * @brief Create a solution cache.
+ *
+ * If file_path is not NULL and the file exists, the entries saved in
+ * it are loaded. A missing or damaged file leaves the cache empty.
+ *
+ * @param capacity Maximum number of entries kept in memory.
+ * @param file_path File backing the cache, or NULL for memory only.
+ * @return The new cache, or NULL if the allocation failed.
+ */
+sudoku_cache_t *SudokuCacheCreate(size_t capacity, const char *file_path);
+
+/**
+ * @brief Save the cache to its file (if any) and free it.
+ */
+void SudokuCacheDestroy(sudoku_cache_t *cache);
+
+/**
+ * @brief Look up the solution of a puzzle.
+ *
+ * @param puzzle 81 cells in row-major order, 0 for empty cells.
+ * @param solution Receives the 81 solved cells on a hit (may be NULL).
+ * @param solution_count Receives the cached solution count on a hit (may be NULL).
+ * @return 1 on a hit, 0 on a miss.
+ */
+int SudokuCacheLookup(sudoku_cache_t *cache, const unsigned char *puzzle,
+                      unsigned char *solution, unsigned int *solution_count);
+
+/**
+ * @brief Insert or refresh the solution of a puzzle.
+ *
+ * The least recently used entry is evicted when the cache is full.
+ */
+void SudokuCacheInsert(sudoku_cache_t *cache, const unsigned char *puzzle,
+                       const unsigned char *solution, unsigned int solution_count);
+
+/**
+ * @brief Write the cache entries to its backing file.
+ *
+ * @return 0 on success (or when the cache has no file), 1 on failure.
+ */
+int SudokuCacheSave(sudoku_cache_t *cache);
+
+/**
+ * @brief Read the hit/miss counters of the cache.
+ */
+void SudokuCacheGetStats(sudoku_cache_t *cache, sudoku_cache_stats_t *stats);
+
+#endif /* SUDOKU_CACHE_H */
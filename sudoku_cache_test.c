@@ -0,0 +1,178 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#include <stdio.h>  /* printf, fprintf, fopen, fseek, fread, fwrite, fclose, remove */
+#include <stdlib.h> /* EXIT_FAILURE, EXIT_SUCCESS */
+#include <string.h> /* memcmp, memcpy */
+
+#include "sudoku.h"
+#include "sudoku_cache.h"
+#include "sudoku_util.h"
+
+#define TEST_CACHE_FILE "sudoku_cache_test.cache"
+#define TEST_ENTRIES 100
+#define TEST_CAPACITY 256
+#define TEST_FILE_HEADER_SIZE 16
+#define TEST_PACKED_SIZE ((SUDOKU_CELLS + 1) / 2)
+#define TEST_RECORD_SIZE (2 * TEST_PACKED_SIZE + 1)
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static void MakeEntry(unsigned int seed, unsigned char *puzzle, unsigned char *solution, unsigned int *solution_count);
+static int CheckRoundTrip();
+static int CheckDamagedFile(long offset, unsigned char flip, int fix_checksum);
+static size_t CountLoadedEntries();
+static int Fail(const char *message);
+
+/*  =================================   */
+/*  API Functions Implementation        */
+/*  =================================   */
+int main()
+{
+    int failed = 0;
+
+    /* A flipped bit is caught by the checksum; with the checksum redone, a solution that contradicts cell 5
+       (always a clue) or an impossible solution count is caught by the entry checks */
+    failed |= CheckRoundTrip() || CheckDamagedFile(TEST_FILE_HEADER_SIZE + 7, 0x01, 0);
+    failed |= CheckRoundTrip() || CheckDamagedFile(TEST_FILE_HEADER_SIZE + TEST_PACKED_SIZE + 2, 0x10, 1);
+    failed |= CheckRoundTrip() || CheckDamagedFile(TEST_FILE_HEADER_SIZE + TEST_RECORD_SIZE - 1, 0x40, 1);
+
+    remove(TEST_CACHE_FILE);
+
+    if (failed)
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("cache: all checks passed\n");
+
+    return EXIT_SUCCESS;
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static void MakeEntry(unsigned int seed, unsigned char *puzzle, unsigned char *solution, unsigned int *solution_count)
+{
+    size_t cell = 0;
+
+    /* A shifted pattern is a valid grid; the seed picks a relabelling and one clue to leave out */
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        solution[cell] = (unsigned char)(((cell / 9) * 3 + (cell / 27) + cell % 9 + seed) % 9 + 1);
+        puzzle[cell] = (0 != cell % 3) ? solution[cell] : 0;
+    }
+    puzzle[(seed / 9) * 3 + 1] = 0;
+    *solution_count = 1;
+
+    /* Some entries record a puzzle without a solution, which keeps the puzzle in place of one */
+    if (0 == seed % 10)
+    {
+        memcpy(solution, puzzle, SUDOKU_CELLS);
+        *solution_count = 0;
+    }
+}
+
+static int CheckRoundTrip()
+{
+    unsigned char puzzle[SUDOKU_CELLS];
+    unsigned char solution[SUDOKU_CELLS];
+    unsigned char cached[SUDOKU_CELLS];
+    unsigned int solution_count = 0;
+    unsigned int cached_count = 0;
+    unsigned int i = 0;
+    sudoku_cache_t *cache = NULL;
+    int failed = 0;
+
+    remove(TEST_CACHE_FILE);
+
+    cache = SudokuCacheCreate(TEST_CAPACITY, TEST_CACHE_FILE);
+    if (NULL == cache)
+    {
+        return Fail("cannot create the cache");
+    }
+    for (i = 0; i < TEST_ENTRIES; ++i)
+    {
+        MakeEntry(i, puzzle, solution, &solution_count);
+        SudokuCacheInsert(cache, puzzle, solution, solution_count);
+    }
+    SudokuCacheDestroy(cache);
+
+    /* A new cache on the same file answers every puzzle without a search */
+    cache = SudokuCacheCreate(TEST_CAPACITY, TEST_CACHE_FILE);
+    if (NULL == cache)
+    {
+        return Fail("cannot reopen the cache");
+    }
+    for (i = 0; (i < TEST_ENTRIES) && !failed; ++i)
+    {
+        MakeEntry(i, puzzle, solution, &solution_count);
+        if (!SudokuCacheLookup(cache, puzzle, cached, &cached_count) || (solution_count != cached_count) ||
+            (0 != memcmp(solution, cached, SUDOKU_CELLS)))
+        {
+            failed = Fail("an entry did not survive saving and loading");
+        }
+    }
+    SudokuCacheDestroy(cache);
+
+    return failed;
+}
+
+static int CheckDamagedFile(long offset, unsigned char flip, int fix_checksum)
+{
+    FILE *file = fopen(TEST_CACHE_FILE, "r+b");
+    unsigned char data[TEST_FILE_HEADER_SIZE + TEST_ENTRIES * TEST_RECORD_SIZE];
+    int failed = 0;
+
+    if (NULL == file)
+    {
+        return Fail("cannot open the cache file");
+    }
+
+    failed = (sizeof(data) != fread(data, 1, sizeof(data), file));
+    data[offset] ^= flip;
+    if (fix_checksum)
+    {
+        SudokuPutUInt32(data + 12, SudokuChecksum(data + TEST_FILE_HEADER_SIZE, sizeof(data) - TEST_FILE_HEADER_SIZE));
+    }
+    failed = failed || (0 != fseek(file, 0, SEEK_SET)) || (sizeof(data) != fwrite(data, 1, sizeof(data), file));
+    failed |= (0 != fclose(file));
+
+    if (failed)
+    {
+        return Fail("cannot damage the cache file");
+    }
+
+    if (0 != CountLoadedEntries())
+    {
+        return Fail("entries were loaded from a damaged file");
+    }
+
+    return 0;
+}
+
+static size_t CountLoadedEntries()
+{
+    sudoku_cache_stats_t stats;
+    sudoku_cache_t *cache = SudokuCacheCreate(TEST_CAPACITY, TEST_CACHE_FILE);
+
+    if (NULL == cache)
+    {
+        return 0;
+    }
+
+    SudokuCacheGetStats(cache, &stats);
+    SudokuCacheDestroy(cache);
+
+    return stats.entries;
+}
+
+static int Fail(const char *message)
+{
+    fprintf(stderr, "cache: FAILED: %s\n", message);
+
+    return 1;
+}
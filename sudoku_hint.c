@@ -0,0 +1,337 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#include <stdlib.h> /* calloc, free */
+
+#include "sudoku.h"
+#include "sudoku_hint.h"
+#include "sudoku_util.h"
+
+#define HINT_DIMENSION 9
+/*  ==================================  */
+/*  ENUMERATIONS & TYPES                */
+/*  ==================================  */
+struct Sudoku_Hint_Engine
+{
+    const sudoku_variant_t *variant; /* Borrowed from the caller, which keeps its board in step */
+    unsigned char value[SUDOKU_CELLS];
+    unsigned short candidates[SUDOKU_CELLS];
+    unsigned char places[SUDOKU_VARIANT_MAX_UNITS][HINT_DIMENSION]; /* Cells left for each digit in each unit */
+};
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static void UpdateCandidates(sudoku_hint_engine_t *engine, unsigned int cell);
+static void UpdatePeers(sudoku_hint_engine_t *engine, unsigned int cell);
+static enum hint_technique GetHiddenSingleTechnique(enum unit_kind kind);
+static unsigned int LowestDigit(unsigned int mask);
+
+/*  =================================   */
+/*  API Functions Implementation        */
+/*  =================================   */
+sudoku_hint_engine_t *HintEngineCreate(const sudoku_variant_t *variant)
+{
+    sudoku_hint_engine_t *engine = (sudoku_hint_engine_t *)calloc(1, sizeof(sudoku_hint_engine_t));
+    if (NULL == engine)
+    {
+        return NULL;
+    }
+
+    engine->variant = variant;
+
+    HintEngineLoad(engine, engine->value);
+
+    return engine;
+}
+
+void HintEngineDestroy(sudoku_hint_engine_t *engine)
+{
+    free(engine);
+    engine = NULL;
+}
+
+void HintEngineLoad(sudoku_hint_engine_t *engine, const unsigned char *cells)
+{
+    unsigned int cell = 0;
+    unsigned int unit = 0;
+    unsigned int digit = 0;
+
+    for (unit = 0; unit < SUDOKU_VARIANT_MAX_UNITS; ++unit)
+    {
+        for (digit = 0; digit < HINT_DIMENSION; ++digit)
+        {
+            engine->places[unit][digit] = 0;
+        }
+    }
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        engine->value[cell] = cells[cell];
+        engine->candidates[cell] = 0;
+    }
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        UpdateCandidates(engine, cell);
+    }
+}
+
+void HintEngineSetCell(sudoku_hint_engine_t *engine, unsigned int row, unsigned int col, unsigned int digit)
+{
+    unsigned int cell = row * HINT_DIMENSION + col;
+
+    if ((0 != engine->value[cell]) || (0 == digit))
+    {
+        return;
+    }
+
+    engine->value[cell] = (unsigned char)digit;
+
+    /* Only the cell and its peers can lose candidates */
+    UpdateCandidates(engine, cell);
+    UpdatePeers(engine, cell);
+}
+
+void HintEngineClearCell(sudoku_hint_engine_t *engine, unsigned int row, unsigned int col)
+{
+    unsigned int cell = row * HINT_DIMENSION + col;
+
+    if (0 == engine->value[cell])
+    {
+        return;
+    }
+
+    engine->value[cell] = 0;
+
+    /* Only the cell and its peers can gain candidates */
+    UpdateCandidates(engine, cell);
+    UpdatePeers(engine, cell);
+}
+
+unsigned int HintEngineGetCandidates(sudoku_hint_engine_t *engine, unsigned int row, unsigned int col)
+{
+    return engine->candidates[row * HINT_DIMENSION + col];
+}
+
+int HintEngineNext(sudoku_hint_engine_t *engine, sudoku_hint_t *hint)
+{
+    const unsigned char *cells = NULL;
+    unsigned int cell = 0;
+    unsigned int unit = 0;
+    unsigned int unit_count = (unsigned int)SudokuVariantUnitCount(engine->variant);
+    unsigned int size = 0;
+    unsigned int digit = 0;
+    unsigned int placed = 0;
+    unsigned int i = 0;
+
+    /* A cell without candidates means the board can no longer be solved */
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if ((0 == engine->value[cell]) && (0 == engine->candidates[cell]))
+        {
+            hint->row = cell / HINT_DIMENSION;
+            hint->col = cell % HINT_DIMENSION;
+            hint->digit = 0;
+            hint->technique = HINT_CONTRADICTION;
+            return 1;
+        }
+    }
+
+    /* So does a digit with no place left in a unit that must hold it; point at the unit's first empty cell */
+    for (unit = 0; unit < unit_count; ++unit)
+    {
+        if (UNIT_CAGE == SudokuVariantUnitKind(engine->variant, unit))
+        {
+            continue;
+        }
+
+        size = (unsigned int)SudokuVariantUnitCells(engine->variant, unit, &cells);
+        placed = 0;
+        cell = SUDOKU_CELLS;
+        for (i = 0; i < size; ++i)
+        {
+            if (0 != engine->value[cells[i]])
+            {
+                placed |= 1 << (engine->value[cells[i]] - 1);
+            }
+            else if (SUDOKU_CELLS == cell)
+            {
+                cell = cells[i];
+            }
+        }
+
+        for (digit = 0; (digit < HINT_DIMENSION) && (SUDOKU_CELLS != cell); ++digit)
+        {
+            if ((0 == (placed & (1 << digit))) && (0 == engine->places[unit][digit]))
+            {
+                hint->row = cell / HINT_DIMENSION;
+                hint->col = cell % HINT_DIMENSION;
+                hint->digit = 0;
+                hint->technique = HINT_CONTRADICTION;
+                return 1;
+            }
+        }
+    }
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (1 == SudokuCountBits(engine->candidates[cell]))
+        {
+            hint->row = cell / HINT_DIMENSION;
+            hint->col = cell % HINT_DIMENSION;
+            hint->digit = LowestDigit(engine->candidates[cell]);
+            hint->technique = HINT_NAKED_SINGLE;
+            return 1;
+        }
+    }
+
+    /* Cages need not hold every digit, so only the other units give hidden singles */
+    for (unit = 0; unit < unit_count; ++unit)
+    {
+        if (UNIT_CAGE == SudokuVariantUnitKind(engine->variant, unit))
+        {
+            continue;
+        }
+
+        size = (unsigned int)SudokuVariantUnitCells(engine->variant, unit, &cells);
+        for (digit = 0; digit < HINT_DIMENSION; ++digit)
+        {
+            if (1 != engine->places[unit][digit])
+            {
+                continue;
+            }
+
+            for (i = 0; i < size; ++i)
+            {
+                cell = cells[i];
+
+                if (engine->candidates[cell] & (1 << digit))
+                {
+                    hint->row = cell / HINT_DIMENSION;
+                    hint->col = cell % HINT_DIMENSION;
+                    hint->digit = digit + 1;
+                    hint->technique = GetHiddenSingleTechnique(SudokuVariantUnitKind(engine->variant, unit));
+                    return 1;
+                }
+            }
+        }
+    }
+
+    hint->technique = HINT_NONE;
+
+    return 0;
+}
+
+const char *HintTechniqueName(enum hint_technique technique)
+{
+    switch (technique)
+    {
+    case HINT_NAKED_SINGLE:
+        return "naked single";
+    case HINT_HIDDEN_SINGLE_ROW:
+        return "hidden single in row";
+    case HINT_HIDDEN_SINGLE_COL:
+        return "hidden single in column";
+    case HINT_HIDDEN_SINGLE_BOX:
+        return "hidden single in box";
+    case HINT_HIDDEN_SINGLE_REGION:
+        return "hidden single in region";
+    case HINT_HIDDEN_SINGLE_DIAGONAL:
+        return "hidden single in diagonal";
+    case HINT_HIDDEN_SINGLE_WINDOW:
+        return "hidden single in window";
+    case HINT_CONTRADICTION:
+        return "no candidates left for a cell or digit";
+    case HINT_SOLUTION:
+        return "from the solution";
+    default:
+        return "none";
+    }
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static void UpdateCandidates(sudoku_hint_engine_t *engine, unsigned int cell)
+{
+    const unsigned char *units = NULL;
+    unsigned int old_candidates = engine->candidates[cell];
+    unsigned int new_candidates = SudokuVariantCandidates(engine->variant, cell);
+    unsigned int unit_count = 0;
+    unsigned int changed = 0;
+    unsigned int digit = 0;
+    unsigned int i = 0;
+
+    unit_count = (unsigned int)SudokuVariantCellUnits(engine->variant, cell, &units);
+
+    /* Adjust the place counts only for the digits that changed */
+    changed = old_candidates ^ new_candidates;
+    for (digit = 0; 0 != changed; ++digit, changed >>= 1)
+    {
+        if (0 == (changed & 1))
+        {
+            continue;
+        }
+
+        for (i = 0; i < unit_count; ++i)
+        {
+            if (new_candidates & (1 << digit))
+            {
+                ++engine->places[units[i]][digit];
+            }
+            else
+            {
+                --engine->places[units[i]][digit];
+            }
+        }
+    }
+
+    engine->candidates[cell] = (unsigned short)new_candidates;
+}
+
+static void UpdatePeers(sudoku_hint_engine_t *engine, unsigned int cell)
+{
+    const unsigned char *peers = NULL;
+    unsigned int peer_count = (unsigned int)SudokuVariantPeers(engine->variant, cell, &peers);
+    unsigned int i = 0;
+
+    for (i = 0; i < peer_count; ++i)
+    {
+        UpdateCandidates(engine, peers[i]);
+    }
+}
+
+static enum hint_technique GetHiddenSingleTechnique(enum unit_kind kind)
+{
+    switch (kind)
+    {
+    case UNIT_ROW:
+        return HINT_HIDDEN_SINGLE_ROW;
+    case UNIT_COL:
+        return HINT_HIDDEN_SINGLE_COL;
+    case UNIT_REGION:
+        return HINT_HIDDEN_SINGLE_REGION;
+    case UNIT_DIAGONAL:
+        return HINT_HIDDEN_SINGLE_DIAGONAL;
+    case UNIT_WINDOW:
+        return HINT_HIDDEN_SINGLE_WINDOW;
+    default:
+        return HINT_HIDDEN_SINGLE_BOX;
+    }
+}
+
+static unsigned int LowestDigit(unsigned int mask)
+{
+    unsigned int digit = 1;
+
+    while (0 == (mask & 1))
+    {
+        mask >>= 1;
+        ++digit;
+    }
+
+    return digit;
+}
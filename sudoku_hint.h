@@ -0,0 +1,115 @@
+/**
+ * @file sudoku_hint.h
+ * @brief Sudoku Hint Engine Interface
+ *
+ * This header file provides the interface for the hint engine used
+ * by the interactive game. The engine keeps the candidates of every
+ * cell and the number of places left for every digit in every unit,
+ * and updates them incrementally as cells are set and cleared, so
+ * finding the next deduction does not re-analyse the whole board.
+ * The units come from the compiled tables of a variant, so hints follow
+ * diagonal, windoku, jigsaw and killer rules as well.
+ *
+ * @author [Zayd Abu Sneineh]
+ */
+
+#ifndef SUDOKU_HINT_H
+#define SUDOKU_HINT_H
+
+#include "sudoku_variant.h"
+
+/**
+ * @enum hint_technique
+ * Enumeration for the deductions a hint can be based on.
+ */
+enum hint_technique
+{
+    HINT_NONE = 0,
+    HINT_NAKED_SINGLE = 1,           /* The cell has one candidate left */
+    HINT_HIDDEN_SINGLE_ROW = 2,      /* The digit fits in one cell of the row */
+    HINT_HIDDEN_SINGLE_COL = 3,      /* The digit fits in one cell of the column */
+    HINT_HIDDEN_SINGLE_BOX = 4,      /* The digit fits in one cell of the box */
+    HINT_CONTRADICTION = 5,          /* The cell, or a digit of its unit, has no candidates left */
+    HINT_SOLUTION = 6,               /* No deduction found, taken from the solution */
+    HINT_HIDDEN_SINGLE_REGION = 7,   /* The digit fits in one cell of the jigsaw region */
+    HINT_HIDDEN_SINGLE_DIAGONAL = 8, /* The digit fits in one cell of the diagonal */
+    HINT_HIDDEN_SINGLE_WINDOW = 9    /* The digit fits in one cell of the window */
+};
+
+/**
+ * @typedef sudoku_hint_engine_t
+ * Typedef for the hint engine structure.
+ * The structure is defined in the implementation file.
+ */
+typedef struct Sudoku_Hint_Engine sudoku_hint_engine_t;
+
+/**
+ * @struct Sudoku_Hint
+ * A single hint: the cell, the digit it takes and why.
+ */
+typedef struct Sudoku_Hint
+{
+    unsigned int row;
+    unsigned int col;
+    unsigned int digit; /* 0 for HINT_CONTRADICTION */
+    enum hint_technique technique;
+} sudoku_hint_t;
+
+/**
+ * @brief Create a hint engine for an empty board.
+ *
+ * @param variant The rules to follow. The engine only reads it and keeps
+ *                the pointer, so it must outlive the engine, and its board
+ *                must hold the same digits as the engine whenever the
+ *                engine is loaded, updated or asked for a hint.
+ * @return The new engine, or NULL if the allocation failed.
+ */
+sudoku_hint_engine_t *HintEngineCreate(const sudoku_variant_t *variant);
+
+/**
+ * @brief Free a hint engine.
+ */
+void HintEngineDestroy(sudoku_hint_engine_t *engine);
+
+/**
+ * @brief Rebuild the engine state from a whole board.
+ *
+ * Used after the board changes in bulk (a new puzzle, or the solution
+ * being revealed).
+ *
+ * @param cells 81 cells in row-major order, 0 for empty cells.
+ */
+void HintEngineLoad(sudoku_hint_engine_t *engine, const unsigned char *cells);
+
+/**
+ * @brief Record a digit placed on the board.
+ */
+void HintEngineSetCell(sudoku_hint_engine_t *engine, unsigned int row, unsigned int col, unsigned int digit);
+
+/**
+ * @brief Record a digit removed from the board.
+ */
+void HintEngineClearCell(sudoku_hint_engine_t *engine, unsigned int row, unsigned int col);
+
+/**
+ * @brief Get the candidates of a cell.
+ *
+ * @return A mask where bit (digit - 1) is set for every legal digit,
+ *         or 0 for a filled cell.
+ */
+unsigned int HintEngineGetCandidates(sudoku_hint_engine_t *engine, unsigned int row, unsigned int col);
+
+/**
+ * @brief Find the next logical deduction on the current board.
+ *
+ * @param hint Receives the hint.
+ * @return 1 if a hint was found, 0 otherwise.
+ */
+int HintEngineNext(sudoku_hint_engine_t *engine, sudoku_hint_t *hint);
+
+/**
+ * @brief Get a readable name for a hint technique.
+ */
+const char *HintTechniqueName(enum hint_technique technique);
+
+#endif /* SUDOKU_HINT_H */
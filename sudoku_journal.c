@@ -0,0 +1,462 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>  /* FILE, fopen, fread, fwrite, fseek, ftell, fflush, fclose, fileno */
+#include <stdlib.h> /* malloc, calloc, free */
+#include <string.h> /* memcmp, memcpy, memset */
+#include <stdint.h> /* uint32_t */
+#include <unistd.h> /* ftruncate */
+
+#include "sudoku.h"
+#include "sudoku_journal.h"
+#include "sudoku_util.h"
+
+#define JOURNAL_FILE_MAGIC "SDKJ"
+#define JOURNAL_VERSION 1
+#define JOURNAL_FILE_HEADER_SIZE 16
+#define JOURNAL_SNAPSHOT_OFFSET 8 /* Where the header keeps the offset of the latest snapshot */
+#define JOURNAL_PACKED_SIZE ((SUDOKU_CELLS + 1) / 2)
+#define JOURNAL_SNAPSHOT_SIZE (2 + 3 * JOURNAL_PACKED_SIZE + 1 + 4) /* type, rules, cells, cursor, checksum */
+#define JOURNAL_SNAPSHOT_INTERVAL 256                               /* Events between two snapshots */
+#define JOURNAL_DIMENSION 9
+/*  ==================================  */
+/*  ENUMERATIONS & TYPES                */
+/*  ==================================  */
+struct Sudoku_Journal
+{
+    FILE *file;
+    sudoku_journal_state_t state; /* Kept in step with the records, for the next snapshot */
+    size_t events_since_snapshot;
+    int failed;
+};
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static int WriteEvent(sudoku_journal_t *journal, unsigned char *record, size_t size);
+static int WriteSnapshot(sudoku_journal_t *journal);
+static int ReadTail(FILE *file, sudoku_journal_state_t *state, long *end, size_t *events);
+static size_t ApplyRecord(const unsigned char *data, size_t size, sudoku_journal_state_t *state,
+                          sudoku_journal_event_t *event);
+static size_t GetRecordSize(unsigned char type);
+static void PackCells(const unsigned char *cells, unsigned char *packed);
+static int UnpackCells(const unsigned char *packed, unsigned char *cells);
+
+/*  =================================   */
+/*  API Functions Implementation        */
+/*  =================================   */
+sudoku_journal_t *SudokuJournalCreate(const char *file_path, const sudoku_journal_state_t *state)
+{
+    unsigned char header[JOURNAL_FILE_HEADER_SIZE] = {0};
+
+    sudoku_journal_t *journal = (sudoku_journal_t *)calloc(1, sizeof(sudoku_journal_t));
+    if (NULL == journal)
+    {
+        return NULL;
+    }
+
+    journal->file = fopen(file_path, "w+b");
+    if (NULL == journal->file)
+    {
+        free(journal);
+        return NULL;
+    }
+
+    memcpy(header, JOURNAL_FILE_MAGIC, 4);
+    header[4] = JOURNAL_VERSION;
+    if (JOURNAL_FILE_HEADER_SIZE != fwrite(header, 1, JOURNAL_FILE_HEADER_SIZE, journal->file))
+    {
+        journal->failed = 1;
+    }
+
+    journal->state = *state;
+    WriteSnapshot(journal);
+
+    return journal;
+}
+
+sudoku_journal_t *SudokuJournalResume(const char *file_path, sudoku_journal_state_t *state)
+{
+    long end = 0;
+
+    sudoku_journal_t *journal = (sudoku_journal_t *)calloc(1, sizeof(sudoku_journal_t));
+    if (NULL == journal)
+    {
+        return NULL;
+    }
+
+    journal->file = fopen(file_path, "r+b");
+    if ((NULL == journal->file) || ReadTail(journal->file, &journal->state, &end, &journal->events_since_snapshot))
+    {
+        if (NULL != journal->file)
+        {
+            fclose(journal->file);
+        }
+        free(journal);
+        return NULL;
+    }
+
+    /* Drop a record cut short by a crash, so new records follow the last complete one */
+    fflush(journal->file);
+    if ((0 != ftruncate(fileno(journal->file), (off_t)end)) || (0 != fseek(journal->file, end, SEEK_SET)))
+    {
+        journal->failed = 1;
+    }
+
+    *state = journal->state;
+
+    return journal;
+}
+
+int SudokuJournalSetCell(sudoku_journal_t *journal, unsigned int cell, unsigned int digit)
+{
+    unsigned char record[4];
+
+    record[0] = JOURNAL_SET_CELL;
+    record[1] = (unsigned char)cell;
+    record[2] = (unsigned char)digit;
+    journal->state.board[cell] = (unsigned char)digit;
+
+    return WriteEvent(journal, record, sizeof(record));
+}
+
+int SudokuJournalClearCell(sudoku_journal_t *journal, unsigned int cell)
+{
+    unsigned char record[3];
+
+    record[0] = JOURNAL_CLEAR_CELL;
+    record[1] = (unsigned char)cell;
+    journal->state.board[cell] = 0;
+
+    return WriteEvent(journal, record, sizeof(record));
+}
+
+int SudokuJournalMoveCursor(sudoku_journal_t *journal, unsigned int cell)
+{
+    unsigned char record[3];
+
+    record[0] = JOURNAL_MOVE_CURSOR;
+    record[1] = (unsigned char)cell;
+    journal->state.cursor = cell;
+
+    return WriteEvent(journal, record, sizeof(record));
+}
+
+int SudokuJournalFlush(sudoku_journal_t *journal)
+{
+    if (0 != fflush(journal->file))
+    {
+        journal->failed = 1;
+    }
+
+    return journal->failed;
+}
+
+int SudokuJournalClose(sudoku_journal_t *journal)
+{
+    int failed = 0;
+
+    SudokuJournalFlush(journal);
+    failed = journal->failed;
+
+    if (0 != fclose(journal->file))
+    {
+        failed = 1;
+    }
+    free(journal);
+
+    return failed;
+}
+
+int SudokuJournalLoad(const char *file_path, sudoku_journal_state_t *state)
+{
+    sudoku_journal_state_t loaded;
+    long end = 0;
+    size_t events = 0;
+    int status = 0;
+
+    FILE *file = fopen(file_path, "rb");
+    if (NULL == file)
+    {
+        return 1;
+    }
+
+    status = ReadTail(file, &loaded, &end, &events);
+    fclose(file);
+
+    if (0 == status)
+    {
+        *state = loaded;
+    }
+
+    return status;
+}
+
+long SudokuJournalReplay(const char *file_path, sudoku_journal_state_t *state, sudoku_journal_replay_t callback,
+                         void *context)
+{
+    sudoku_journal_state_t replayed;
+    sudoku_journal_event_t event;
+    unsigned char *data = NULL;
+    long size = 0;
+    long count = 0;
+    size_t position = JOURNAL_FILE_HEADER_SIZE;
+    size_t used = 0;
+
+    FILE *file = fopen(file_path, "rb");
+    if (NULL == file)
+    {
+        return -1;
+    }
+
+    /* The whole file is read at once, then replayed from memory */
+    if ((0 != fseek(file, 0, SEEK_END)) || (JOURNAL_FILE_HEADER_SIZE >= (size = ftell(file))) ||
+        (NULL == (data = (unsigned char *)malloc((size_t)size))))
+    {
+        fclose(file);
+        return -1;
+    }
+    rewind(file);
+    if (((size_t)size != fread(data, 1, (size_t)size, file)) || (0 != memcmp(data, JOURNAL_FILE_MAGIC, 4)) ||
+        (JOURNAL_VERSION != data[4]) || (JOURNAL_SNAPSHOT != data[JOURNAL_FILE_HEADER_SIZE]))
+    {
+        free(data);
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+
+    memset(&replayed, 0, sizeof(replayed));
+    while (0 != (used = ApplyRecord(data + position, (size_t)size - position, &replayed, &event)))
+    {
+        position += used;
+        ++count;
+
+        if (NULL != callback)
+        {
+            callback(&event, &replayed, context);
+        }
+    }
+    free(data);
+
+    if (0 == count)
+    {
+        return -1;
+    }
+    *state = replayed;
+
+    return count;
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static int WriteEvent(sudoku_journal_t *journal, unsigned char *record, size_t size)
+{
+    record[size - 1] = (unsigned char)(SudokuChecksum(record, size - 1) & 0xFF);
+    if (size != fwrite(record, 1, size, journal->file))
+    {
+        journal->failed = 1;
+    }
+
+    if (JOURNAL_SNAPSHOT_INTERVAL <= ++journal->events_since_snapshot)
+    {
+        WriteSnapshot(journal);
+    }
+
+    return journal->failed;
+}
+
+static int WriteSnapshot(sudoku_journal_t *journal)
+{
+    unsigned char record[JOURNAL_SNAPSHOT_SIZE];
+    unsigned char offset[4];
+    long position = ftell(journal->file);
+
+    record[0] = JOURNAL_SNAPSHOT;
+    record[1] = (unsigned char)journal->state.rules;
+    PackCells(journal->state.givens, record + 2);
+    PackCells(journal->state.board, record + 2 + JOURNAL_PACKED_SIZE);
+    PackCells(journal->state.solution, record + 2 + 2 * JOURNAL_PACKED_SIZE);
+    record[2 + 3 * JOURNAL_PACKED_SIZE] = (unsigned char)journal->state.cursor;
+    SudokuPutUInt32(record + JOURNAL_SNAPSHOT_SIZE - 4, SudokuChecksum(record, JOURNAL_SNAPSHOT_SIZE - 4));
+
+    /* The header is only pointed at the snapshot once the snapshot itself is written */
+    if ((0 > position) || (JOURNAL_SNAPSHOT_SIZE != fwrite(record, 1, JOURNAL_SNAPSHOT_SIZE, journal->file)) ||
+        (0 != fflush(journal->file)))
+    {
+        journal->failed = 1;
+        return 1;
+    }
+
+    SudokuPutUInt32(offset, (uint32_t)position);
+    if ((0 != fseek(journal->file, JOURNAL_SNAPSHOT_OFFSET, SEEK_SET)) ||
+        (sizeof(offset) != fwrite(offset, 1, sizeof(offset), journal->file)) || (0 != fflush(journal->file)) ||
+        (0 != fseek(journal->file, 0, SEEK_END)))
+    {
+        journal->failed = 1;
+    }
+    journal->events_since_snapshot = 0;
+
+    return journal->failed;
+}
+
+static int ReadTail(FILE *file, sudoku_journal_state_t *state, long *end, size_t *events)
+{
+    unsigned char header[JOURNAL_FILE_HEADER_SIZE];
+    sudoku_journal_event_t event;
+    unsigned char *data = NULL;
+    long offset = 0;
+    long size = 0;
+    size_t position = 0;
+    size_t used = 0;
+
+    if ((JOURNAL_FILE_HEADER_SIZE != fread(header, 1, JOURNAL_FILE_HEADER_SIZE, file)) ||
+        (0 != memcmp(header, JOURNAL_FILE_MAGIC, 4)) || (JOURNAL_VERSION != header[4]))
+    {
+        return 1;
+    }
+
+    offset = (long)SudokuGetUInt32(header + JOURNAL_SNAPSHOT_OFFSET);
+    if ((JOURNAL_FILE_HEADER_SIZE > offset) || (0 != fseek(file, 0, SEEK_END)) || (offset >= (size = ftell(file))))
+    {
+        return 1;
+    }
+
+    /* Only the latest snapshot and the records after it are read */
+    data = (unsigned char *)malloc((size_t)(size - offset));
+    if ((NULL == data) || (0 != fseek(file, offset, SEEK_SET)) ||
+        ((size_t)(size - offset) != fread(data, 1, (size_t)(size - offset), file)) || (JOURNAL_SNAPSHOT != data[0]))
+    {
+        free(data);
+        return 1;
+    }
+
+    memset(state, 0, sizeof(*state));
+    *events = 0;
+    while (0 != (used = ApplyRecord(data + position, (size_t)(size - offset) - position, state, &event)))
+    {
+        position += used;
+        ++*events;
+    }
+    free(data);
+
+    /* A damaged snapshot leaves nothing to resume from */
+    if (0 == *events)
+    {
+        return 1;
+    }
+
+    --*events;
+    *end = offset + (long)position;
+
+    return 0;
+}
+
+static size_t ApplyRecord(const unsigned char *data, size_t size, sudoku_journal_state_t *state,
+                          sudoku_journal_event_t *event)
+{
+    sudoku_journal_state_t snapshot;
+    size_t record_size = (0 != size) ? GetRecordSize(data[0]) : 0;
+
+    /* A record cut short or damaged ends the journal */
+    if ((0 == record_size) || (record_size > size))
+    {
+        return 0;
+    }
+
+    event->type = (enum journal_event)data[0];
+    event->cell = 0;
+    event->digit = 0;
+
+    if (JOURNAL_SNAPSHOT == data[0])
+    {
+        if ((SudokuChecksum(data, JOURNAL_SNAPSHOT_SIZE - 4) != SudokuGetUInt32(data + JOURNAL_SNAPSHOT_SIZE - 4)) ||
+            UnpackCells(data + 2, snapshot.givens) || UnpackCells(data + 2 + JOURNAL_PACKED_SIZE, snapshot.board) ||
+            UnpackCells(data + 2 + 2 * JOURNAL_PACKED_SIZE, snapshot.solution) ||
+            (SUDOKU_CELLS <= data[2 + 3 * JOURNAL_PACKED_SIZE]))
+        {
+            return 0;
+        }
+
+        snapshot.rules = data[1];
+        snapshot.cursor = data[2 + 3 * JOURNAL_PACKED_SIZE];
+        *state = snapshot;
+
+        return record_size;
+    }
+
+    if (((SudokuChecksum(data, record_size - 1) & 0xFF) != data[record_size - 1]) || (SUDOKU_CELLS <= data[1]))
+    {
+        return 0;
+    }
+    event->cell = data[1];
+
+    switch (data[0])
+    {
+    case JOURNAL_SET_CELL:
+        if ((1 > data[2]) || (JOURNAL_DIMENSION < data[2]))
+        {
+            return 0;
+        }
+        event->digit = data[2];
+        state->board[data[1]] = data[2];
+        break;
+    case JOURNAL_CLEAR_CELL:
+        state->board[data[1]] = 0;
+        break;
+    case JOURNAL_MOVE_CURSOR:
+        state->cursor = data[1];
+        break;
+    }
+
+    return record_size;
+}
+
+static size_t GetRecordSize(unsigned char type)
+{
+    switch (type)
+    {
+    case JOURNAL_SNAPSHOT:
+        return JOURNAL_SNAPSHOT_SIZE;
+    case JOURNAL_SET_CELL:
+        return 4;
+    case JOURNAL_CLEAR_CELL:
+    case JOURNAL_MOVE_CURSOR:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+static void PackCells(const unsigned char *cells, unsigned char *packed)
+{
+    size_t cell = 0;
+
+    memset(packed, 0, JOURNAL_PACKED_SIZE);
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        packed[cell / 2] |= (unsigned char)((cells[cell] & 0x0F) << (4 * (cell % 2)));
+    }
+}
+
+static int UnpackCells(const unsigned char *packed, unsigned char *cells)
+{
+    size_t cell = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        cells[cell] = (unsigned char)((packed[cell / 2] >> (4 * (cell % 2))) & 0x0F);
+        if (JOURNAL_DIMENSION < cells[cell])
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
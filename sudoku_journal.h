@@ -0,0 +1,153 @@
+/**
+ * @file sudoku_journal.h
+ * @brief Sudoku Session Journal Interface
+ *
+ * This header file provides the interface for the journal that keeps a
+ * game across quits and crashes. The journal is an append-only file of
+ * small records: a snapshot of the whole session (rules, givens, board,
+ * solution and cursor, packed two cells per byte), then one record of two
+ * to four bytes for every digit set, cell cleared or cursor move.
+ *
+ * A fresh snapshot is appended every few hundred events, and the file
+ * header points at the latest one, so resuming reads one snapshot and a
+ * short tail no matter how long the session was. Replaying a journal from
+ * its first record visits every event in order and always ends in the
+ * same state, which makes recorded sessions usable as regression and
+ * performance tests.
+ *
+ * @author [Zayd Abu Sneineh]
+ */
+
+#ifndef SUDOKU_JOURNAL_H
+#define SUDOKU_JOURNAL_H
+
+#include "sudoku.h"
+
+/**
+ * @enum journal_event
+ * Enumeration for the records of a journal.
+ */
+enum journal_event
+{
+    JOURNAL_SNAPSHOT = 1,    /* The whole session */
+    JOURNAL_SET_CELL = 2,    /* A digit was written in a cell */
+    JOURNAL_CLEAR_CELL = 3,  /* A cell was emptied */
+    JOURNAL_MOVE_CURSOR = 4  /* The cursor moved to a cell */
+};
+
+/**
+ * @struct Sudoku_Journal_State
+ * A session as the journal sees it. Cells are numbered row * 9 + col.
+ */
+typedef struct Sudoku_Journal_State
+{
+    unsigned int rules;                   /* enum variant_rule flags */
+    unsigned char givens[SUDOKU_CELLS];   /* The puzzle, 0 for empty cells */
+    unsigned char board[SUDOKU_CELLS];    /* Givens and the player's digits */
+    unsigned char solution[SUDOKU_CELLS];
+    unsigned int cursor;
+} sudoku_journal_state_t;
+
+/**
+ * @struct Sudoku_Journal_Event
+ * One record, as passed to a replay callback.
+ */
+typedef struct Sudoku_Journal_Event
+{
+    enum journal_event type;
+    unsigned int cell;  /* Not used by snapshots */
+    unsigned int digit; /* Only used by JOURNAL_SET_CELL */
+} sudoku_journal_event_t;
+
+/**
+ * @typedef sudoku_journal_replay_t
+ * Called for every record during a replay, with the state after it.
+ */
+typedef void (*sudoku_journal_replay_t)(const sudoku_journal_event_t *event, const sudoku_journal_state_t *state,
+                                        void *context);
+
+/**
+ * @typedef sudoku_journal_t
+ * Typedef for the journal writer structure.
+ * The structure is defined in the implementation file.
+ */
+typedef struct Sudoku_Journal sudoku_journal_t;
+
+/**
+ * @brief Start a journal, replacing any file at that path.
+ *
+ * @param state The session to start from, written as the first snapshot.
+ * @return The new journal, or NULL if the file cannot be created.
+ */
+sudoku_journal_t *SudokuJournalCreate(const char *file_path, const sudoku_journal_state_t *state);
+
+/**
+ * @brief Resume a journal and keep appending to it.
+ *
+ * A record cut short by a crash is dropped from the end of the file.
+ *
+ * @param state Receives the session as of the last complete record.
+ * @return The journal, or NULL if the file is missing or not a journal.
+ */
+sudoku_journal_t *SudokuJournalResume(const char *file_path, sudoku_journal_state_t *state);
+
+/**
+ * @brief Record a digit written in a cell.
+ *
+ * @return 0 on success, 1 if a write failed.
+ */
+int SudokuJournalSetCell(sudoku_journal_t *journal, unsigned int cell, unsigned int digit);
+
+/**
+ * @brief Record a cell emptied.
+ *
+ * @return 0 on success, 1 if a write failed.
+ */
+int SudokuJournalClearCell(sudoku_journal_t *journal, unsigned int cell);
+
+/**
+ * @brief Record a cursor move.
+ *
+ * @return 0 on success, 1 if a write failed.
+ */
+int SudokuJournalMoveCursor(sudoku_journal_t *journal, unsigned int cell);
+
+/**
+ * @brief Hand the buffered records to the operating system.
+ *
+ * Records reach the file when the buffer fills, at every snapshot and
+ * here; the game flushes once per key, so a crash loses at most the key
+ * being handled.
+ *
+ * @return 0 on success, 1 if a write failed.
+ */
+int SudokuJournalFlush(sudoku_journal_t *journal);
+
+/**
+ * @brief Flush and close a journal. The file is kept for a later resume.
+ *
+ * @return 0 on success, 1 if a write failed.
+ */
+int SudokuJournalClose(sudoku_journal_t *journal);
+
+/**
+ * @brief Read the session of a journal without opening it for writing.
+ *
+ * Only the latest snapshot and the records after it are read.
+ *
+ * @return 0 on success, 1 if the file is missing or not a journal.
+ */
+int SudokuJournalLoad(const char *file_path, sudoku_journal_state_t *state);
+
+/**
+ * @brief Replay a journal from its first record.
+ *
+ * @param state Receives the session after the last complete record.
+ * @param callback Called after every record (may be NULL).
+ * @return Number of records replayed, or -1 if the file is missing or
+ *         not a journal.
+ */
+long SudokuJournalReplay(const char *file_path, sudoku_journal_state_t *state, sudoku_journal_replay_t callback,
+                         void *context);
+
+#endif /* SUDOKU_JOURNAL_H */
@@ -0,0 +1,215 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#include <stdio.h>  /* printf, fprintf, fopen, fseek, ftell, fwrite, fclose, remove */
+#include <stdlib.h> /* EXIT_FAILURE, EXIT_SUCCESS */
+#include <string.h> /* memcmp, memset */
+
+#include "sudoku.h"
+#include "sudoku_journal.h"
+
+#define TEST_JOURNAL_FILE "sudoku_journal_test.sdkj"
+#define TEST_EVENTS 700 /* Enough for a few snapshots */
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static int RecordSession(sudoku_journal_state_t *expected);
+static int CheckTornTail(sudoku_journal_state_t *expected, const unsigned char *tail, size_t tail_size);
+static int AppendBytes(const unsigned char *bytes, size_t size, long *size_before);
+static long GetFileSize();
+static int IsSameState(const sudoku_journal_state_t *left, const sudoku_journal_state_t *right);
+static int Fail(const char *message);
+
+/*  =================================   */
+/*  API Functions Implementation        */
+/*  =================================   */
+int main()
+{
+    static const unsigned char half_record[] = {JOURNAL_SET_CELL, 40};
+    static const unsigned char bad_check[] = {JOURNAL_CLEAR_CELL, 40, 0};
+    static const unsigned char half_snapshot[] = {JOURNAL_SNAPSHOT, 0, 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE};
+
+    sudoku_journal_state_t expected;
+    sudoku_journal_state_t state;
+    int failed = 0;
+
+    failed |= RecordSession(&expected);
+
+    if ((0 > SudokuJournalReplay(TEST_JOURNAL_FILE, &state, NULL, NULL)) || !IsSameState(&state, &expected))
+    {
+        failed |= Fail("replaying the journal does not give the recorded session");
+    }
+
+    /* A crash can leave part of a record, or a whole record whose check byte never made it */
+    failed |= CheckTornTail(&expected, half_record, sizeof(half_record));
+    failed |= CheckTornTail(&expected, bad_check, sizeof(bad_check));
+    failed |= CheckTornTail(&expected, half_snapshot, sizeof(half_snapshot));
+
+    remove(TEST_JOURNAL_FILE);
+
+    if (failed)
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("journal: all checks passed\n");
+
+    return EXIT_SUCCESS;
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static int RecordSession(sudoku_journal_state_t *expected)
+{
+    sudoku_journal_t *journal = NULL;
+    unsigned int cell = 0;
+    unsigned int i = 0;
+    int failed = 0;
+
+    memset(expected, 0, sizeof(*expected));
+    expected->rules = VARIANT_CLASSIC;
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        expected->solution[cell] = (unsigned char)(((cell / 9) * 3 + (cell / 27) + cell % 9) % 9 + 1);
+        expected->givens[cell] = (0 == cell % 4) ? expected->solution[cell] : 0;
+        expected->board[cell] = expected->givens[cell];
+    }
+
+    journal = SudokuJournalCreate(TEST_JOURNAL_FILE, expected);
+    if (NULL == journal)
+    {
+        return Fail("cannot create the journal");
+    }
+
+    /* Walk the empty cells, writing, moving and clearing as a player would */
+    for (i = 0; i < TEST_EVENTS; ++i)
+    {
+        cell = (i * 7) % SUDOKU_CELLS;
+        if (0 != expected->givens[cell])
+        {
+            continue;
+        }
+
+        failed |= SudokuJournalMoveCursor(journal, cell);
+        expected->cursor = cell;
+        if (0 == i % 5)
+        {
+            failed |= SudokuJournalClearCell(journal, cell);
+            expected->board[cell] = 0;
+        }
+        else
+        {
+            failed |= SudokuJournalSetCell(journal, cell, expected->solution[cell]);
+            expected->board[cell] = expected->solution[cell];
+        }
+    }
+
+    if (failed || SudokuJournalClose(journal))
+    {
+        return Fail("writing the journal");
+    }
+
+    return 0;
+}
+
+static int CheckTornTail(sudoku_journal_state_t *expected, const unsigned char *tail, size_t tail_size)
+{
+    sudoku_journal_state_t state;
+    sudoku_journal_t *journal = NULL;
+    unsigned int cell = 1; /* Not a given */
+    long size_before = 0;
+
+    if (AppendBytes(tail, tail_size, &size_before))
+    {
+        return Fail("cannot damage the journal");
+    }
+
+    if (SudokuJournalLoad(TEST_JOURNAL_FILE, &state) || !IsSameState(&state, expected))
+    {
+        return Fail("loading a torn journal does not give the last complete session");
+    }
+
+    journal = SudokuJournalResume(TEST_JOURNAL_FILE, &state);
+    if ((NULL == journal) || !IsSameState(&state, expected))
+    {
+        if (NULL != journal)
+        {
+            SudokuJournalClose(journal);
+        }
+        return Fail("resuming a torn journal does not give the last complete session");
+    }
+
+    /* The torn bytes are cut off, so a new record follows the last complete one */
+    expected->board[cell] = (0 != expected->board[cell]) ? 0 : expected->solution[cell];
+    if (((0 != expected->board[cell]) ? SudokuJournalSetCell(journal, cell, expected->board[cell])
+                                      : SudokuJournalClearCell(journal, cell)) ||
+        SudokuJournalClose(journal))
+    {
+        return Fail("appending after a resume");
+    }
+
+    if (GetFileSize() != size_before + ((0 != expected->board[cell]) ? 4 : 3))
+    {
+        return Fail("the torn bytes were not cut off");
+    }
+
+    if (SudokuJournalLoad(TEST_JOURNAL_FILE, &state) || !IsSameState(&state, expected))
+    {
+        return Fail("the record written after a resume was lost");
+    }
+
+    return 0;
+}
+
+static int AppendBytes(const unsigned char *bytes, size_t size, long *size_before)
+{
+    FILE *file = fopen(TEST_JOURNAL_FILE, "ab");
+    int failed = 0;
+
+    if (NULL == file)
+    {
+        return 1;
+    }
+
+    failed = (0 != fseek(file, 0, SEEK_END)) || (0 > (*size_before = ftell(file))) ||
+             (size != fwrite(bytes, 1, size, file));
+    failed |= (0 != fclose(file));
+
+    return failed;
+}
+
+static long GetFileSize()
+{
+    FILE *file = fopen(TEST_JOURNAL_FILE, "rb");
+    long size = -1;
+
+    if (NULL != file)
+    {
+        if (0 == fseek(file, 0, SEEK_END))
+        {
+            size = ftell(file);
+        }
+        fclose(file);
+    }
+
+    return size;
+}
+
+static int IsSameState(const sudoku_journal_state_t *left, const sudoku_journal_state_t *right)
+{
+    return (left->rules == right->rules) && (left->cursor == right->cursor) &&
+           (0 == memcmp(left->givens, right->givens, SUDOKU_CELLS)) &&
+           (0 == memcmp(left->board, right->board, SUDOKU_CELLS)) &&
+           (0 == memcmp(left->solution, right->solution, SUDOKU_CELLS));
+}
+
+static int Fail(const char *message)
+{
+    fprintf(stderr, "journal: FAILED: %s\n", message);
+
+    return 1;
+}
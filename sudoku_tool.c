@@ -0,0 +1,1704 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>      /* printf, fprintf, snprintf, sscanf, fopen, fgets, fclose, putchar */
+#include <stdlib.h>     /* EXIT_FAILURE, EXIT_SUCCESS, malloc, calloc, realloc, free, atoi, strtoul */
+#include <string.h>     /* strcmp, strncmp, strchr, strrchr, strerror, memcpy, memmove, memset */
+#include <float.h>      /* DBL_MAX */
+#include <time.h>       /* clock_gettime, nanosleep */
+#include <unistd.h>     /* sysconf, close, unlink */
+#include <errno.h>      /* errno, EAGAIN, EWOULDBLOCK, EINTR */
+#include <fcntl.h>      /* fcntl, O_NONBLOCK */
+#include <pthread.h>    /* pthread_create, pthread_join, pthread_mutex_t */
+#include <poll.h>       /* poll */
+#include <netdb.h>      /* getaddrinfo, freeaddrinfo */
+#include <sys/socket.h> /* socket, bind, listen, accept, connect, send, recv */
+#include <sys/un.h>     /* sockaddr_un */
+
+#include "sudoku.h"
+#include "sudoku_archive.h"
+#include "sudoku_batch.h"
+#include "sudoku_util.h"
+
+#define TOOL_MAX_THREADS 64
+#define TOOL_DIMENSION 9
+#define SEARCH_MAX_CLUES 20            /* Puzzles with more clues are explored but not kept */
+#define SEARCH_MOVES_PER_GRID 4000     /* Clue exchanges tried on a grid before a new one is made */
+#define SEARCH_GRID_SEED_CLUES 11      /* Random clues solved into a full grid */
+#define SEARCH_SEEN_INITIAL 65536      /* Initial slots of the shared set of explored puzzles */
+#define SEARCH_REPORT_SECONDS 10
+#define SHARD_PROTOCOL "sudoku-search 1"
+#define SHARD_LINE_SIZE 128             /* Longest protocol line, newline included */
+#define SHARD_INPUT_SIZE 4096
+#define SHARD_OUTPUT_SIZE 1024          /* Replies waiting for a worker to read them */
+#define SHARD_CERTIFY_PER_POLL 32       /* Puzzles certified between two polls, so no worker waits on another */
+#define SHARD_MAX_CLIENTS 256
+#define SHARD_LEASE_SECONDS 600         /* A worker silent for this long loses its range */
+#define SHARD_MAX_RANGE_SIZE 4096       /* Seeds per lease, which bounds the work lost with a worker */
+#define SHARD_CONNECT_TRIES 30          /* One second apart */
+#define SHARD_DONE_SECONDS 5            /* Time left to workers to hear that everything is done */
+/*  ==================================  */
+/*  ENUMERATIONS & TYPES                */
+/*  ==================================  */
+typedef struct Solve_Job
+{
+    sudoku_archive_reader_t *reader;
+    pthread_mutex_t lock;
+    size_t puzzles;
+    size_t solved;
+    int damaged;
+} solve_job_t;
+
+typedef struct Search_Stats
+{
+    unsigned long grids;
+    unsigned long checks;      /* Uniqueness checks (solver calls with a limit of two solutions) */
+    unsigned long moves;
+    unsigned long minimal;     /* Minimal puzzles reached */
+    unsigned long pruned;      /* Minimal puzzles already explored, by any thread or worker */
+    unsigned long kept;
+    unsigned long kept_by_clues[SUDOKU_CELLS + 1];
+} search_stats_t;
+
+typedef struct Search_Job
+{
+    sudoku_archive_writer_t *writer;
+    pthread_mutex_t lock;
+    unsigned long next_seed;
+    unsigned int max_clues;
+    double deadline;
+    int failed;
+
+    /* Set for workers, which send kept puzzles to the coordinator instead of writing them */
+    int connection;
+    unsigned long range;
+
+    /* Hashes of every minimal puzzle reached by any thread (0 marks a free slot) */
+    unsigned long long *seen;
+    size_t seen_capacity;
+    size_t seen_count;
+
+    search_stats_t stats;
+} search_job_t;
+
+/*
+ * Workers lease ranges of seeds from the coordinator. A range is only
+ * written out once its worker reports it complete; if the worker goes
+ * away first, its puzzles are dropped and the range is leased again.
+ * Results depend only on the seeds, so a range run twice gives the same
+ * puzzles and nothing is lost or written twice.
+ */
+enum shard_range_state
+{
+    SHARD_RANGE_PENDING = 0,
+    SHARD_RANGE_LEASED = 1,
+    SHARD_RANGE_COMPLETE = 2
+};
+
+typedef struct Shard_Client
+{
+    int fd;
+    char input[SHARD_INPUT_SIZE];
+    size_t input_length;
+    char output[SHARD_OUTPUT_SIZE];
+    size_t output_length;
+    int greeted;
+    int dropped;
+    int completing;         /* The range is reported complete and its puzzles are being certified */
+    long range;             /* Leased range, -1 for none */
+    unsigned char *puzzles; /* Puzzles of the leased range, held until it is complete */
+    size_t puzzle_count;
+    size_t puzzle_capacity;
+    size_t certified;       /* Puzzles of a completing range certified so far */
+    double last_active;
+} shard_client_t;
+
+typedef struct Shard_Server
+{
+    search_job_t job;
+    unsigned char *ranges;
+    size_t range_count;
+    size_t complete_count;
+    unsigned long first_seed;
+    unsigned long seed_count;
+    unsigned long range_size;
+    unsigned long received;
+    unsigned long duplicates;
+    unsigned long rejected;
+    unsigned long requeued;
+} shard_server_t;
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static int PackArchive(int argc, char **argv);
+static int UnpackArchive(int argc, char **argv);
+static int SolveArchive(int argc, char **argv);
+static void *SolveArchiveWorker(void *arg);
+static int SearchPuzzles(int argc, char **argv);
+static void *SearchWorker(void *arg);
+static void SearchGrid(search_job_t *job, unsigned long seed, search_stats_t *stats);
+static void MakeFullGrid(unsigned long long *random_state, unsigned char *grid);
+static unsigned int MinimizePuzzle(unsigned long long *random_state, unsigned char *puzzle, search_stats_t *stats);
+static int IsMinimalPuzzle(const unsigned char *puzzle, search_stats_t *stats);
+static int IsLegalClue(const unsigned char *puzzle, size_t cell, unsigned char digit);
+static int MarkPuzzleSeen(search_job_t *job, const unsigned char *puzzle);
+static int KeepPuzzle(search_job_t *job, const unsigned char *puzzle, unsigned int clues);
+static void AddSearchStats(search_stats_t *total, search_stats_t *stats);
+static void PrintSearchStats(const search_stats_t *stats, double seconds);
+static unsigned long long NextRandom(unsigned long long *random_state);
+static int ServeSearch(int argc, char **argv);
+static int HandleShardLine(shard_server_t *server, shard_client_t *client, const char *line);
+static size_t CertifyShardRange(shard_server_t *server, shard_client_t *client, size_t limit);
+static void DropShardClient(shard_server_t *server, shard_client_t *client);
+static int QueueShardLine(shard_client_t *client, const char *line);
+static int FlushShardOutput(shard_client_t *client);
+static int WorkSearch(int argc, char **argv);
+static int WorkShardRanges(search_job_t *job, int fd, search_stats_t *stats, unsigned long *ranges_done);
+static int OpenSocket(const char *address, int listening);
+static int SendLine(int fd, const char *line);
+static int SendPuzzle(int fd, unsigned long range, const unsigned char *puzzle);
+static int ReceiveLine(int fd, char *input, size_t *input_length, char *line);
+static int TakeLine(char *input, size_t *input_length, char *line);
+static int ParsePuzzle(const char *line, unsigned char *puzzle);
+static void PrintPuzzle(FILE *file, const unsigned char *puzzle);
+static size_t ClampThreadCount(size_t thread_count);
+static size_t StartThreads(pthread_t *threads, size_t thread_count, void *(*worker)(void *), void *job);
+static double GetSeconds();
+static void PrintUsage(const char *program);
+
+/*  =================================   */
+/*  Main                                */
+/*  =================================   */
+int main(int argc, char **argv)
+{
+    if ((4 <= argc) && (0 == strcmp(argv[1], "pack")))
+    {
+        return PackArchive(argc - 2, argv + 2);
+    }
+    if ((3 <= argc) && (0 == strcmp(argv[1], "unpack")))
+    {
+        return UnpackArchive(argc - 2, argv + 2);
+    }
+    if ((3 <= argc) && (0 == strcmp(argv[1], "solve")))
+    {
+        return SolveArchive(argc - 2, argv + 2);
+    }
+    if ((3 <= argc) && (0 == strcmp(argv[1], "search")))
+    {
+        return SearchPuzzles(argc - 2, argv + 2);
+    }
+    if ((4 <= argc) && (0 == strcmp(argv[1], "serve")))
+    {
+        return ServeSearch(argc - 2, argv + 2);
+    }
+    if ((3 <= argc) && (0 == strcmp(argv[1], "work")))
+    {
+        return WorkSearch(argc - 2, argv + 2);
+    }
+
+    PrintUsage(argv[0]);
+
+    return EXIT_FAILURE;
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static int PackArchive(int argc, char **argv)
+{
+    char line[256];
+    unsigned char puzzle[SUDOKU_CELLS];
+    size_t written = 0;
+    size_t rejected = 0;
+    FILE *input = NULL;
+    sudoku_archive_writer_t *writer = NULL;
+
+    /* main only calls this with the puzzle file and the archive */
+    (void)argc;
+    input = fopen(argv[0], "r");
+    if (NULL == input)
+    {
+        fprintf(stderr, "Cannot read puzzles from %s.\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    writer = SudokuArchiveCreate(argv[1]);
+    if (NULL == writer)
+    {
+        fprintf(stderr, "Cannot create %s.\n", argv[1]);
+        fclose(input);
+        return EXIT_FAILURE;
+    }
+
+    while (NULL != fgets(line, sizeof(line), input))
+    {
+        if (!ParsePuzzle(line, puzzle))
+        {
+            continue;
+        }
+
+        if (SudokuArchiveWrite(writer, puzzle))
+        {
+            ++rejected;
+        }
+        else
+        {
+            ++written;
+        }
+    }
+
+    fclose(input);
+
+    if (SudokuArchiveClose(writer))
+    {
+        fprintf(stderr, "Writing %s failed.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%lu puzzles packed, %lu rejected\n", (unsigned long)written, (unsigned long)rejected);
+
+    return EXIT_SUCCESS;
+}
+
+static int UnpackArchive(int argc, char **argv)
+{
+    unsigned char *puzzles = NULL;
+    size_t count = 0;
+    size_t i = 0;
+    sudoku_archive_reader_t *reader = NULL;
+
+    /* main only calls this with the archive */
+    (void)argc;
+    reader = SudokuArchiveOpen(argv[0]);
+    if (NULL == reader)
+    {
+        fprintf(stderr, "Cannot open %s.\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    puzzles = (unsigned char *)malloc((size_t)SUDOKU_ARCHIVE_BLOCK_PUZZLES * SUDOKU_CELLS);
+    if (NULL == puzzles)
+    {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (0 != (count = SudokuArchiveRead(reader, puzzles, SUDOKU_ARCHIVE_BLOCK_PUZZLES)))
+    {
+        for (i = 0; i < count; ++i)
+        {
+            PrintPuzzle(stdout, puzzles + i * SUDOKU_CELLS);
+        }
+    }
+
+    free(puzzles);
+    SudokuArchiveCloseReader(reader);
+
+    return EXIT_SUCCESS;
+}
+
+static int SolveArchive(int argc, char **argv)
+{
+    pthread_t threads[TOOL_MAX_THREADS];
+    solve_job_t job;
+    size_t thread_count = 1;
+    size_t i = 0;
+    double start = 0;
+    double seconds = 0;
+
+    if (2 <= argc)
+    {
+        thread_count = ClampThreadCount((size_t)atoi(argv[1]));
+    }
+
+    job.reader = SudokuArchiveOpen(argv[0]);
+    if (NULL == job.reader)
+    {
+        fprintf(stderr, "Cannot open %s.\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+    job.puzzles = 0;
+    job.solved = 0;
+    job.damaged = 0;
+
+    /* Every thread pulls whole blocks, then decodes and solves them on its own */
+    start = GetSeconds();
+    thread_count = StartThreads(threads, thread_count, SolveArchiveWorker, &job);
+    for (i = 0; i < thread_count; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    seconds = GetSeconds() - start;
+
+    if (0 == thread_count)
+    {
+        pthread_mutex_destroy(&job.lock);
+        SudokuArchiveCloseReader(job.reader);
+        return EXIT_FAILURE;
+    }
+
+    printf("%lu puzzles, %lu solved, %lu threads, %.3f s (%.0f puzzles/sec)\n", (unsigned long)job.puzzles,
+           (unsigned long)job.solved, (unsigned long)thread_count, seconds, job.puzzles / seconds);
+
+    pthread_mutex_destroy(&job.lock);
+    SudokuArchiveCloseReader(job.reader);
+
+    if (job.damaged)
+    {
+        fprintf(stderr, "The archive is damaged.\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static void *SolveArchiveWorker(void *arg)
+{
+    solve_job_t *job = (solve_job_t *)arg;
+    sudoku_archive_block_t block = {NULL, 0, 0, 0};
+    unsigned char *puzzles = NULL;
+    unsigned char *solutions = NULL;
+    size_t count = 0;
+    size_t solved = 0;
+    int status = 0;
+
+    puzzles = (unsigned char *)malloc((size_t)SUDOKU_ARCHIVE_BLOCK_PUZZLES * SUDOKU_CELLS);
+    solutions = (unsigned char *)malloc((size_t)SUDOKU_ARCHIVE_BLOCK_PUZZLES * SUDOKU_CELLS);
+    if ((NULL == puzzles) || (NULL == solutions))
+    {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (1 == (status = SudokuArchiveNextBlock(job->reader, &block)))
+    {
+        count = SudokuArchiveDecodeBlock(&block, puzzles, SUDOKU_ARCHIVE_BLOCK_PUZZLES);
+        solved = SolveSudokuBatch(puzzles, solutions, NULL, count);
+
+        pthread_mutex_lock(&job->lock);
+        job->puzzles += count;
+        job->solved += solved;
+        pthread_mutex_unlock(&job->lock);
+    }
+
+    if (-1 == status)
+    {
+        pthread_mutex_lock(&job->lock);
+        job->damaged = 1;
+        pthread_mutex_unlock(&job->lock);
+    }
+
+    SudokuArchiveFreeBlock(&block);
+    free(puzzles);
+    free(solutions);
+
+    return NULL;
+}
+
+static int SearchPuzzles(int argc, char **argv)
+{
+    pthread_t threads[TOOL_MAX_THREADS];
+    struct timespec pause = {1, 0};
+    search_job_t job;
+    search_stats_t stats;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = (0 < cpus) ? (size_t)cpus : 1;
+    double seconds = 60;
+    double start = 0;
+    double next_report = 0;
+    double now = 0;
+    size_t i = 0;
+
+    memset(&job, 0, sizeof(job));
+    job.max_clues = SEARCH_MAX_CLUES;
+    job.next_seed = 1;
+
+    if (2 <= argc)
+    {
+        thread_count = (size_t)atoi(argv[1]);
+    }
+    if (3 <= argc)
+    {
+        seconds = atof(argv[2]);
+    }
+    if (4 <= argc)
+    {
+        job.max_clues = (unsigned int)atoi(argv[3]);
+    }
+    if (5 <= argc)
+    {
+        job.next_seed = strtoul(argv[4], NULL, 10);
+    }
+    thread_count = ClampThreadCount(thread_count);
+    if ((17 > job.max_clues) || (SUDOKU_CELLS < job.max_clues) || (0 >= seconds))
+    {
+        fprintf(stderr, "The clue limit must be at least 17 and the time positive.\n");
+        return EXIT_FAILURE;
+    }
+
+    job.seen_capacity = SEARCH_SEEN_INITIAL;
+    job.seen = (unsigned long long *)calloc(job.seen_capacity, sizeof(*job.seen));
+    if (NULL == job.seen)
+    {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    job.writer = SudokuArchiveCreate(argv[0]);
+    if (NULL == job.writer)
+    {
+        fprintf(stderr, "Cannot create %s.\n", argv[0]);
+        free(job.seen);
+        return EXIT_FAILURE;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+
+    /* Every thread makes its own grids from seeds it takes in turn, and all of them share the explored puzzles */
+    start = GetSeconds();
+    job.deadline = start + seconds;
+    next_report = start + SEARCH_REPORT_SECONDS;
+    thread_count = StartThreads(threads, thread_count, SearchWorker, &job);
+    if (0 == thread_count)
+    {
+        SudokuArchiveClose(job.writer);
+        pthread_mutex_destroy(&job.lock);
+        free(job.seen);
+        return EXIT_FAILURE;
+    }
+
+    while ((now = GetSeconds()) < job.deadline)
+    {
+        if (now >= next_report)
+        {
+            pthread_mutex_lock(&job.lock);
+            stats = job.stats;
+            pthread_mutex_unlock(&job.lock);
+
+            fprintf(stderr, "%.0f s: %lu grids, %lu minimal, %lu kept\n", now - start, stats.grids, stats.minimal,
+                    stats.kept);
+            next_report += SEARCH_REPORT_SECONDS;
+        }
+        nanosleep(&pause, NULL);
+    }
+
+    for (i = 0; i < thread_count; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    seconds = GetSeconds() - start;
+
+    printf("%lu threads, %.1f s, clue limit %u, seeds up to %lu\n", (unsigned long)thread_count, seconds,
+           job.max_clues, job.next_seed - 1);
+    PrintSearchStats(&job.stats, seconds);
+
+    if (SudokuArchiveClose(job.writer))
+    {
+        job.failed = 1;
+    }
+
+    pthread_mutex_destroy(&job.lock);
+    free(job.seen);
+
+    if (job.failed)
+    {
+        fprintf(stderr, "Writing %s failed.\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static void *SearchWorker(void *arg)
+{
+    search_job_t *job = (search_job_t *)arg;
+    search_stats_t stats;
+    unsigned long seed = 0;
+
+    while (GetSeconds() < job->deadline)
+    {
+        pthread_mutex_lock(&job->lock);
+        seed = job->next_seed++;
+        pthread_mutex_unlock(&job->lock);
+
+        memset(&stats, 0, sizeof(stats));
+        SearchGrid(job, seed, &stats);
+
+        pthread_mutex_lock(&job->lock);
+        AddSearchStats(&job->stats, &stats);
+        pthread_mutex_unlock(&job->lock);
+    }
+
+    return NULL;
+}
+
+static void SearchGrid(search_job_t *job, unsigned long seed, search_stats_t *stats)
+{
+    unsigned long long state = 0x9E3779B97F4A7C15ULL * (seed + 1); /* The grid and moves depend only on the seed */
+    unsigned long long *random_state = &state;
+    unsigned char grid[SUDOKU_CELLS];
+    unsigned char puzzle[SUDOKU_CELLS];
+    unsigned char candidate[SUDOKU_CELLS];
+    unsigned char clue_cells[SUDOKU_CELLS];
+    unsigned char free_cells[SUDOKU_CELLS];
+    size_t clue_count = 0;
+    size_t free_count = 0;
+    size_t removed = 0;
+    size_t cell = 0;
+    size_t i = 0;
+    unsigned long move = 0;
+    unsigned int clues = 0;
+    unsigned int candidate_clues = 0;
+
+    MakeFullGrid(random_state, grid);
+    ++stats->grids;
+
+    memcpy(puzzle, grid, SUDOKU_CELLS);
+    clues = MinimizePuzzle(random_state, puzzle, stats);
+    ++stats->minimal;
+    if (!MarkPuzzleSeen(job, puzzle))
+    {
+        ++stats->pruned;
+        return;
+    }
+    if ((clues <= job->max_clues) && KeepPuzzle(job, puzzle, clues))
+    {
+        ++stats->kept;
+        ++stats->kept_by_clues[clues];
+    }
+
+    /*
+     * Walk from minimal puzzle to minimal puzzle: drop one or two clues, add
+     * a clue from the grid in an empty cell, and minimize again if the
+     * result still has one solution. Dropping two gives a puzzle with fewer
+     * clues, dropping one moves along puzzles with the same count.
+     */
+    for (move = 0; (move < SEARCH_MOVES_PER_GRID) && (0 == (move & 63) ? GetSeconds() < job->deadline : 1); ++move)
+    {
+        clue_count = 0;
+        free_count = 0;
+        for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+        {
+            if (0 != puzzle[cell])
+            {
+                clue_cells[clue_count++] = (unsigned char)cell;
+            }
+            else
+            {
+                free_cells[free_count++] = (unsigned char)cell;
+            }
+        }
+
+        memcpy(candidate, puzzle, SUDOKU_CELLS);
+        removed = 1 + (NextRandom(random_state) & 1);
+        for (i = 0; i < removed; ++i)
+        {
+            cell = i + NextRandom(random_state) % (clue_count - i);
+            candidate[clue_cells[cell]] = 0;
+            clue_cells[cell] = clue_cells[i];
+        }
+        cell = free_cells[NextRandom(random_state) % free_count];
+        candidate[cell] = grid[cell];
+
+        ++stats->moves;
+        ++stats->checks;
+        if (1 != SolveSudokuScalar(candidate, NULL, 2))
+        {
+            continue;
+        }
+
+        candidate_clues = MinimizePuzzle(random_state, candidate, stats);
+        ++stats->minimal;
+        if (!MarkPuzzleSeen(job, candidate))
+        {
+            /* Some thread already walked on from this puzzle */
+            ++stats->pruned;
+            continue;
+        }
+
+        memcpy(puzzle, candidate, SUDOKU_CELLS);
+        clues = candidate_clues;
+        if ((clues <= job->max_clues) && KeepPuzzle(job, puzzle, clues))
+        {
+            ++stats->kept;
+            ++stats->kept_by_clues[clues];
+        }
+    }
+}
+
+static void MakeFullGrid(unsigned long long *random_state, unsigned char *grid)
+{
+    unsigned char seed_puzzle[SUDOKU_CELLS];
+    size_t placed = 0;
+    size_t cell = 0;
+    unsigned char digit = 0;
+
+    /* A few random clues are almost always solvable, and the solver completes them into a grid */
+    do
+    {
+        memset(seed_puzzle, 0, sizeof(seed_puzzle));
+        for (placed = 0; placed < SEARCH_GRID_SEED_CLUES;)
+        {
+            cell = (size_t)(NextRandom(random_state) % SUDOKU_CELLS);
+            digit = (unsigned char)(1 + NextRandom(random_state) % TOOL_DIMENSION);
+            if ((0 == seed_puzzle[cell]) && IsLegalClue(seed_puzzle, cell, digit))
+            {
+                seed_puzzle[cell] = digit;
+                ++placed;
+            }
+        }
+    } while (0 == SolveSudokuScalar(seed_puzzle, grid, 1));
+}
+
+static unsigned int MinimizePuzzle(unsigned long long *random_state, unsigned char *puzzle, search_stats_t *stats)
+{
+    unsigned char cells[SUDOKU_CELLS];
+    size_t count = 0;
+    size_t cell = 0;
+    size_t i = 0;
+    size_t j = 0;
+    unsigned char digit = 0;
+    unsigned int clues = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (0 != puzzle[cell])
+        {
+            cells[count++] = (unsigned char)cell;
+        }
+    }
+    for (i = count; 1 < i; --i)
+    {
+        j = (size_t)(NextRandom(random_state) % i);
+        digit = cells[i - 1];
+        cells[i - 1] = cells[j];
+        cells[j] = digit;
+    }
+
+    /*
+     * One pass in random order is enough: a clue that cannot go now cannot
+     * go later either, since removing more clues only adds solutions.
+     */
+    clues = (unsigned int)count;
+    for (i = 0; i < count; ++i)
+    {
+        digit = puzzle[cells[i]];
+        puzzle[cells[i]] = 0;
+        ++stats->checks;
+        if (1 == SolveSudokuScalar(puzzle, NULL, 2))
+        {
+            --clues;
+        }
+        else
+        {
+            puzzle[cells[i]] = digit;
+        }
+    }
+
+    return clues;
+}
+
+static int IsMinimalPuzzle(const unsigned char *puzzle, search_stats_t *stats)
+{
+    unsigned char copy[SUDOKU_CELLS];
+    size_t cell = 0;
+
+    memcpy(copy, puzzle, SUDOKU_CELLS);
+    ++stats->checks;
+    if (1 != SolveSudokuScalar(copy, NULL, 2))
+    {
+        return 0;
+    }
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (0 == copy[cell])
+        {
+            continue;
+        }
+
+        copy[cell] = 0;
+        ++stats->checks;
+        if (2 != SolveSudokuScalar(copy, NULL, 2))
+        {
+            return 0;
+        }
+        copy[cell] = puzzle[cell];
+    }
+
+    return 1;
+}
+
+static int IsLegalClue(const unsigned char *puzzle, size_t cell, unsigned char digit)
+{
+    size_t row = cell / TOOL_DIMENSION;
+    size_t col = cell % TOOL_DIMENSION;
+    size_t box = (row / 3) * 3 * TOOL_DIMENSION + (col / 3) * 3;
+    size_t i = 0;
+
+    for (i = 0; i < TOOL_DIMENSION; ++i)
+    {
+        if ((digit == puzzle[row * TOOL_DIMENSION + i]) || (digit == puzzle[i * TOOL_DIMENSION + col]) ||
+            (digit == puzzle[box + (i / 3) * TOOL_DIMENSION + i % 3]))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int MarkPuzzleSeen(search_job_t *job, const unsigned char *puzzle)
+{
+    unsigned long long hash = SudokuHashPuzzle(puzzle);
+    unsigned long long *old_seen = NULL;
+    size_t old_capacity = 0;
+    size_t slot = 0;
+    size_t i = 0;
+    int is_new = 1;
+
+    pthread_mutex_lock(&job->lock);
+
+    /* Keep the table at most half full, so probes stay short */
+    if (2 * (job->seen_count + 1) > job->seen_capacity)
+    {
+        old_seen = job->seen;
+        old_capacity = job->seen_capacity;
+        job->seen_capacity *= 2;
+        job->seen = (unsigned long long *)calloc(job->seen_capacity, sizeof(*job->seen));
+        if (NULL == job->seen)
+        {
+            fprintf(stderr, "Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        for (i = 0; i < old_capacity; ++i)
+        {
+            if (0 != old_seen[i])
+            {
+                for (slot = old_seen[i] & (job->seen_capacity - 1); 0 != job->seen[slot];
+                     slot = (slot + 1) & (job->seen_capacity - 1))
+                {
+                }
+                job->seen[slot] = old_seen[i];
+            }
+        }
+        free(old_seen);
+    }
+
+    for (slot = hash & (job->seen_capacity - 1); 0 != job->seen[slot]; slot = (slot + 1) & (job->seen_capacity - 1))
+    {
+        if (hash == job->seen[slot])
+        {
+            is_new = 0;
+            break;
+        }
+    }
+    if (is_new)
+    {
+        job->seen[slot] = hash;
+        ++job->seen_count;
+    }
+
+    pthread_mutex_unlock(&job->lock);
+
+    return is_new;
+}
+
+static int KeepPuzzle(search_job_t *job, const unsigned char *puzzle, unsigned int clues)
+{
+    search_stats_t certificate;
+    int status = 0;
+
+    /* Every kept puzzle is checked again from scratch: one solution, and two or more without any one of its clues */
+    memset(&certificate, 0, sizeof(certificate));
+    if (!IsMinimalPuzzle(puzzle, &certificate))
+    {
+        fprintf(stderr, "A %u-clue puzzle failed its minimality check.\n", clues);
+        return 0;
+    }
+
+    pthread_mutex_lock(&job->lock);
+    if (NULL != job->writer)
+    {
+        status = SudokuArchiveWrite(job->writer, puzzle);
+    }
+    else
+    {
+        status = SendPuzzle(job->connection, job->range, puzzle);
+    }
+    if (status)
+    {
+        job->failed = 1;
+    }
+    job->stats.checks += certificate.checks;
+    pthread_mutex_unlock(&job->lock);
+
+    return !status;
+}
+
+static void AddSearchStats(search_stats_t *total, search_stats_t *stats)
+{
+    size_t clues = 0;
+
+    total->grids += stats->grids;
+    total->checks += stats->checks;
+    total->moves += stats->moves;
+    total->minimal += stats->minimal;
+    total->pruned += stats->pruned;
+    total->kept += stats->kept;
+    for (clues = 0; clues <= SUDOKU_CELLS; ++clues)
+    {
+        total->kept_by_clues[clues] += stats->kept_by_clues[clues];
+    }
+}
+
+static void PrintSearchStats(const search_stats_t *stats, double seconds)
+{
+    double hours = seconds / 3600;
+    size_t clues = 0;
+
+    printf("%lu grids (%.0f/hour), %lu moves, %lu uniqueness checks (%.0f/sec)\n", stats->grids,
+           stats->grids / hours, stats->moves, stats->checks, stats->checks / seconds);
+    printf("%lu minimal puzzles (%.0f/hour), %lu already explored\n", stats->minimal,
+           stats->minimal / hours, stats->pruned);
+    printf("%lu certified puzzles kept (%.1f/hour)\n", stats->kept, stats->kept / hours);
+    for (clues = 0; clues <= SUDOKU_CELLS; ++clues)
+    {
+        if (0 != stats->kept_by_clues[clues])
+        {
+            printf("  %2lu clues: %lu (%.1f/hour)\n", (unsigned long)clues, stats->kept_by_clues[clues],
+                   stats->kept_by_clues[clues] / hours);
+        }
+    }
+}
+
+static unsigned long long NextRandom(unsigned long long *random_state)
+{
+    unsigned long long value = 0;
+
+    /* splitmix64, so that every seed gives its own stream without sharing rand() */
+    *random_state += 0x9E3779B97F4A7C15ULL;
+    value = *random_state;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+    return value ^ (value >> 31);
+}
+
+static int ServeSearch(int argc, char **argv)
+{
+    shard_client_t *clients[SHARD_MAX_CLIENTS];
+    struct pollfd polls[SHARD_MAX_CLIENTS + 1];
+    shard_server_t server;
+    shard_client_t *client = NULL;
+    char line[SHARD_LINE_SIZE];
+    const char *address = NULL;
+    size_t client_count = 0;
+    size_t next_client = 0;
+    size_t budget = 0;
+    size_t i = 0;
+    ssize_t received = 0;
+    int certifying = 0;
+    double start = 0;
+    double next_report = 0;
+    double done_deadline = 0;
+    double now = 0;
+    int listener = -1;
+    int fd = -1;
+
+    memset(&server, 0, sizeof(server));
+    address = argv[1];
+    server.seed_count = (3 <= argc) ? strtoul(argv[2], NULL, 10) : 1024;
+    server.range_size = (4 <= argc) ? strtoul(argv[3], NULL, 10) : 16;
+    server.job.max_clues = (5 <= argc) ? (unsigned int)atoi(argv[4]) : SEARCH_MAX_CLUES;
+    server.first_seed = (6 <= argc) ? strtoul(argv[5], NULL, 10) : 1;
+    if ((0 == server.seed_count) || (0 == server.range_size) || (SHARD_MAX_RANGE_SIZE < server.range_size) ||
+        (17 > server.job.max_clues) || (SUDOKU_CELLS < server.job.max_clues))
+    {
+        fprintf(stderr, "The seed count must be positive, the range size 1 to %d and the clue limit at least 17.\n",
+                SHARD_MAX_RANGE_SIZE);
+        return EXIT_FAILURE;
+    }
+
+    server.range_count = (server.seed_count + server.range_size - 1) / server.range_size;
+    server.ranges = (unsigned char *)calloc(server.range_count, 1);
+    server.job.seen_capacity = SEARCH_SEEN_INITIAL;
+    server.job.seen = (unsigned long long *)calloc(server.job.seen_capacity, sizeof(*server.job.seen));
+    if ((NULL == server.ranges) || (NULL == server.job.seen))
+    {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&server.job.lock, NULL);
+
+    server.job.writer = SudokuArchiveCreate(argv[0]);
+    if (NULL == server.job.writer)
+    {
+        fprintf(stderr, "Cannot create %s.\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    listener = OpenSocket(address, 1);
+    if (-1 == listener)
+    {
+        fprintf(stderr, "Cannot listen on %s.\n", address);
+        exit(EXIT_FAILURE);
+    }
+
+    start = GetSeconds();
+    now = start;
+    next_report = start + SEARCH_REPORT_SECONDS;
+    while ((server.complete_count < server.range_count) || ((0 != client_count) && (now < done_deadline)))
+    {
+        /* Connections never block the loop: replies wait in a buffer until the socket takes them */
+        polls[0].fd = listener;
+        polls[0].events = POLLIN;
+        for (i = 0; i < client_count; ++i)
+        {
+            polls[i + 1].fd = clients[i]->fd;
+            polls[i + 1].events = (short)((clients[i]->completing ? 0 : POLLIN) |
+                                          ((0 != clients[i]->output_length) ? POLLOUT : 0));
+        }
+
+        if (-1 == poll(polls, client_count + 1, certifying ? 0 : 1000))
+        {
+            continue;
+        }
+        now = GetSeconds();
+
+        if ((0 != (polls[0].revents & POLLIN)) && (-1 != (fd = accept(listener, NULL, NULL))))
+        {
+            client = (SHARD_MAX_CLIENTS > client_count) ? (shard_client_t *)calloc(1, sizeof(*client)) : NULL;
+            if ((NULL == client) || (-1 == fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK)))
+            {
+                free(client);
+                close(fd);
+            }
+            else
+            {
+                client->fd = fd;
+                client->range = -1;
+                client->last_active = now;
+                clients[client_count] = client;
+                polls[client_count + 1].revents = 0;
+                ++client_count;
+            }
+        }
+
+        for (i = 0; i < client_count; ++i)
+        {
+            client = clients[i];
+            if (0 != (polls[i + 1].revents & (POLLIN | POLLHUP | POLLERR)))
+            {
+                received = recv(client->fd, client->input + client->input_length,
+                                sizeof(client->input) - client->input_length, 0);
+                if (0 < received)
+                {
+                    client->input_length += (size_t)received;
+                    client->last_active = now;
+                }
+                else if ((0 == received) || ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno)))
+                {
+                    client->dropped = 1;
+                }
+            }
+
+            if (!client->dropped && (0 != (polls[i + 1].revents & POLLOUT)))
+            {
+                client->dropped = FlushShardOutput(client);
+            }
+
+            /* Lines that came in while a range was being certified are handled once it is done */
+            while (!client->dropped && !client->completing && TakeLine(client->input, &client->input_length, line))
+            {
+                client->dropped = HandleShardLine(&server, client, line);
+            }
+
+            /* A full buffer without a newline is not a worker talking this protocol */
+            if (sizeof(client->input) == client->input_length)
+            {
+                client->dropped = 1;
+            }
+
+            if (!client->dropped && !client->completing && (-1 != client->range) &&
+                (now - client->last_active > SHARD_LEASE_SECONDS))
+            {
+                fprintf(stderr, "A worker held range %ld too long.\n", client->range);
+                client->dropped = 1;
+            }
+        }
+
+        /* Certify a bounded number of puzzles per pass, starting with a different worker each time */
+        budget = SHARD_CERTIFY_PER_POLL;
+        certifying = 0;
+        for (i = 0; i < client_count; ++i)
+        {
+            client = clients[(next_client + i) % client_count];
+            if (client->completing)
+            {
+                budget -= CertifyShardRange(&server, client, budget);
+                certifying |= client->completing;
+            }
+        }
+        next_client = (0 != client_count) ? (next_client + 1) % client_count : 0;
+
+        /* Drop the clients marked above, and give their ranges back; a range being certified is kept */
+        for (i = 0; i < client_count;)
+        {
+            client = clients[i];
+            if (client->dropped && (-1 != client->fd))
+            {
+                FlushShardOutput(client);
+                close(client->fd);
+                client->fd = -1;
+            }
+
+            if (client->dropped && !client->completing)
+            {
+                DropShardClient(&server, client);
+                clients[i] = clients[--client_count];
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        if ((server.complete_count == server.range_count) && (0 == done_deadline))
+        {
+            done_deadline = now + SHARD_DONE_SECONDS;
+        }
+
+        if (now >= next_report)
+        {
+            fprintf(stderr, "%.0f s: %lu of %lu ranges, %lu workers, %lu kept\n", now - start,
+                    (unsigned long)server.complete_count, (unsigned long)server.range_count,
+                    (unsigned long)client_count, server.job.stats.kept);
+            next_report += SEARCH_REPORT_SECONDS;
+        }
+    }
+
+    for (i = 0; i < client_count; ++i)
+    {
+        if (!QueueShardLine(clients[i], "DONE"))
+        {
+            FlushShardOutput(clients[i]);
+        }
+        close(clients[i]->fd);
+        DropShardClient(&server, clients[i]);
+    }
+    close(listener);
+    if ((NULL == strchr(address, ':')) || (NULL != strchr(address, '/')))
+    {
+        unlink(address);
+    }
+    now = GetSeconds();
+
+    printf("%lu seeds from %lu in %lu ranges, %.1f s, clue limit %u\n", server.seed_count, server.first_seed,
+           (unsigned long)server.range_count, now - start, server.job.max_clues);
+    printf("%lu puzzles received, %lu duplicates, %lu rejected, %lu ranges leased again\n", server.received,
+           server.duplicates, server.rejected, server.requeued);
+    printf("%lu certified puzzles kept (%.1f/hour)\n", server.job.stats.kept,
+           server.job.stats.kept / ((now - start) / 3600));
+    for (i = 0; i <= SUDOKU_CELLS; ++i)
+    {
+        if (0 != server.job.stats.kept_by_clues[i])
+        {
+            printf("  %2lu clues: %lu\n", (unsigned long)i, server.job.stats.kept_by_clues[i]);
+        }
+    }
+
+    if (SudokuArchiveClose(server.job.writer))
+    {
+        server.job.failed = 1;
+    }
+    pthread_mutex_destroy(&server.job.lock);
+    free(server.job.seen);
+    free(server.ranges);
+
+    if (server.job.failed)
+    {
+        fprintf(stderr, "Writing %s failed.\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int HandleShardLine(shard_server_t *server, shard_client_t *client, const char *line)
+{
+    char reply[SHARD_LINE_SIZE];
+    char cells[SUDOKU_CELLS + 2];
+    unsigned char *puzzles = NULL;
+    unsigned long first = 0;
+    unsigned long range = 0;
+    size_t capacity = 0;
+    size_t i = 0;
+
+    if (!client->greeted)
+    {
+        if (0 != strcmp(line, "HELLO " SHARD_PROTOCOL))
+        {
+            QueueShardLine(client, "ERROR expected HELLO " SHARD_PROTOCOL);
+            return 1;
+        }
+        client->greeted = 1;
+        return 0;
+    }
+
+    if ((0 == strcmp(line, "REQUEST")) && (-1 == client->range))
+    {
+        for (i = 0; (i < server->range_count) && (SHARD_RANGE_PENDING != server->ranges[i]); ++i)
+        {
+        }
+
+        /* Every range is leased: the worker asks again, in case one comes back */
+        if (i == server->range_count)
+        {
+            return QueueShardLine(client, (server->complete_count == server->range_count) ? "DONE" : "WAIT");
+        }
+
+        first = server->first_seed + i * server->range_size;
+        server->ranges[i] = SHARD_RANGE_LEASED;
+        client->range = (long)i;
+        snprintf(reply, sizeof(reply), "RANGE %lu %lu %lu %u", (unsigned long)i, first,
+                 (i + 1 < server->range_count) ? server->range_size : server->seed_count - i * server->range_size,
+                 server->job.max_clues);
+
+        return QueueShardLine(client, reply);
+    }
+
+    if ((2 == sscanf(line, "PUZZLE %lu %82s", &range, cells)) && ((long)range == client->range))
+    {
+        if (client->puzzle_count == client->puzzle_capacity)
+        {
+            capacity = (0 != client->puzzle_capacity) ? 2 * client->puzzle_capacity : 64;
+            puzzles = (unsigned char *)realloc(client->puzzles, capacity * SUDOKU_CELLS);
+            if (NULL == puzzles)
+            {
+                fprintf(stderr, "Memory allocation failed.\n");
+                exit(EXIT_FAILURE);
+            }
+            client->puzzles = puzzles;
+            client->puzzle_capacity = capacity;
+        }
+
+        if ((SUDOKU_CELLS != strlen(cells)) ||
+            !ParsePuzzle(cells, client->puzzles + client->puzzle_count * SUDOKU_CELLS))
+        {
+            return 1;
+        }
+        ++client->puzzle_count;
+
+        return 0;
+    }
+
+    /* Sent after every seed; receiving it has already renewed the lease */
+    if ((1 == sscanf(line, "PROGRESS %lu", &range)) && ((long)range == client->range))
+    {
+        return 0;
+    }
+
+    /* The puzzles are certified a few at a time by the serve loop, which sends the ACK */
+    if ((1 == sscanf(line, "COMPLETE %lu", &range)) && ((long)range == client->range))
+    {
+        client->completing = 1;
+        client->certified = 0;
+        return 0;
+    }
+
+    fprintf(stderr, "Unexpected message from a worker: %s\n", line);
+
+    return 1;
+}
+
+static size_t CertifyShardRange(shard_server_t *server, shard_client_t *client, size_t limit)
+{
+    search_stats_t certificate;
+    char reply[SHARD_LINE_SIZE];
+    const unsigned char *puzzle = NULL;
+    unsigned int clues = 0;
+    size_t count = 0;
+    size_t cell = 0;
+
+    /* Workers may run on other hosts, so their puzzles are certified again before they are kept */
+    for (count = 0; (count < limit) && (client->certified < client->puzzle_count); ++count, ++client->certified)
+    {
+        puzzle = client->puzzles + client->certified * SUDOKU_CELLS;
+        clues = 0;
+        for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+        {
+            clues += (0 != puzzle[cell]);
+        }
+
+        ++server->received;
+        memset(&certificate, 0, sizeof(certificate));
+        if ((clues > server->job.max_clues) || !IsMinimalPuzzle(puzzle, &certificate))
+        {
+            ++server->rejected;
+        }
+        else if (!MarkPuzzleSeen(&server->job, puzzle))
+        {
+            ++server->duplicates;
+        }
+        else if (SudokuArchiveWrite(server->job.writer, puzzle))
+        {
+            server->job.failed = 1;
+        }
+        else
+        {
+            ++server->job.stats.kept;
+            ++server->job.stats.kept_by_clues[clues];
+        }
+    }
+
+    if (client->certified < client->puzzle_count)
+    {
+        return count;
+    }
+
+    /* Every puzzle was handed over with COMPLETE, so the range is done even if its worker has gone */
+    server->ranges[client->range] = SHARD_RANGE_COMPLETE;
+    ++server->complete_count;
+    snprintf(reply, sizeof(reply), "ACK %ld", client->range);
+    client->range = -1;
+    client->puzzle_count = 0;
+    client->completing = 0;
+
+    if (!client->dropped)
+    {
+        client->dropped = QueueShardLine(client, reply);
+    }
+
+    return count;
+}
+
+static void DropShardClient(shard_server_t *server, shard_client_t *client)
+{
+    if (-1 != client->range)
+    {
+        server->ranges[client->range] = SHARD_RANGE_PENDING;
+        ++server->requeued;
+    }
+
+    free(client->puzzles);
+    free(client);
+}
+
+static int WorkSearch(int argc, char **argv)
+{
+    struct timespec pause = {1, 0};
+    search_job_t job;
+    search_stats_t stats;
+    unsigned long ranges_done = 0;
+    size_t tries = 0;
+    double start = 0;
+    int fd = -1;
+    int status = 1;
+
+    /* main only calls this with the address */
+    (void)argc;
+    memset(&job, 0, sizeof(job));
+    memset(&stats, 0, sizeof(stats));
+    job.deadline = DBL_MAX;
+    job.seen_capacity = SEARCH_SEEN_INITIAL;
+    job.seen = (unsigned long long *)calloc(job.seen_capacity, sizeof(*job.seen));
+    if (NULL == job.seen)
+    {
+        fprintf(stderr, "Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&job.lock, NULL);
+
+    /* Reconnect after a lost connection; the coordinator has already given back the range that was cut short */
+    start = GetSeconds();
+    for (tries = 0; (1 == status) && (tries < SHARD_CONNECT_TRIES); ++tries)
+    {
+        fd = OpenSocket(argv[0], 0);
+        if (-1 == fd)
+        {
+            nanosleep(&pause, NULL);
+            continue;
+        }
+
+        tries = 0;
+        status = WorkShardRanges(&job, fd, &stats, &ranges_done);
+        close(fd);
+    }
+
+    fprintf(stderr, "%lu ranges, %lu grids, %lu puzzles sent, %.1f s\n", ranges_done, stats.grids, stats.kept,
+            GetSeconds() - start);
+
+    pthread_mutex_destroy(&job.lock);
+    free(job.seen);
+
+    if (1 == status)
+    {
+        fprintf(stderr, "Cannot reach the coordinator at %s.\n", argv[0]);
+    }
+    if (0 != status)
+    {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int WorkShardRanges(search_job_t *job, int fd, search_stats_t *stats, unsigned long *ranges_done)
+{
+    struct timespec pause = {1, 0};
+    char input[SHARD_INPUT_SIZE];
+    char line[SHARD_LINE_SIZE];
+    char expected[SHARD_LINE_SIZE];
+    size_t input_length = 0;
+    unsigned long range = 0;
+    unsigned long first = 0;
+    unsigned long count = 0;
+    unsigned long seed = 0;
+
+    if (SendLine(fd, "HELLO " SHARD_PROTOCOL))
+    {
+        return 1;
+    }
+
+    while (!SendLine(fd, "REQUEST") && ReceiveLine(fd, input, &input_length, line))
+    {
+        if (0 == strcmp(line, "DONE"))
+        {
+            return 0;
+        }
+        if (0 == strcmp(line, "WAIT"))
+        {
+            nanosleep(&pause, NULL);
+            continue;
+        }
+        if (4 != sscanf(line, "RANGE %lu %lu %lu %u", &range, &first, &count, &job->max_clues))
+        {
+            fprintf(stderr, "Unexpected message from the coordinator: %s\n", line);
+            return -1;
+        }
+
+        /* Forget the puzzles of earlier ranges, so a range gives the same puzzles whoever runs it */
+        memset(job->seen, 0, job->seen_capacity * sizeof(*job->seen));
+        job->seen_count = 0;
+        job->connection = fd;
+        job->range = range;
+        job->failed = 0;
+
+        /* Report every seed, so a range without puzzles for a long time keeps its lease */
+        snprintf(line, sizeof(line), "PROGRESS %lu", range);
+        for (seed = first; (seed < first + count) && !job->failed; ++seed)
+        {
+            SearchGrid(job, seed, stats);
+            if (SendLine(fd, line))
+            {
+                job->failed = 1;
+            }
+        }
+
+        snprintf(line, sizeof(line), "COMPLETE %lu", range);
+        snprintf(expected, sizeof(expected), "ACK %lu", range);
+        if (job->failed || SendLine(fd, line) || !ReceiveLine(fd, input, &input_length, line) ||
+            (0 != strcmp(line, expected)))
+        {
+            return 1;
+        }
+        ++*ranges_done;
+    }
+
+    return 1;
+}
+
+static int OpenSocket(const char *address, int listening)
+{
+    struct sockaddr_un local;
+    struct addrinfo hints;
+    struct addrinfo *addresses = NULL;
+    struct addrinfo *entry = NULL;
+    char host[256];
+    const char *port = strrchr(address, ':');
+    int reuse = 1;
+    int fd = -1;
+
+    /* host:port is TCP, anything else (or anything with a slash) is the path of a Unix socket */
+    if ((NULL == port) || (NULL != strchr(address, '/')))
+    {
+        memset(&local, 0, sizeof(local));
+        if (sizeof(local.sun_path) <= strlen(address))
+        {
+            return -1;
+        }
+        local.sun_family = AF_UNIX;
+        strcpy(local.sun_path, address);
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (-1 == fd)
+        {
+            return -1;
+        }
+        if (listening)
+        {
+            unlink(address);
+        }
+        if (listening ? ((0 != bind(fd, (struct sockaddr *)&local, sizeof(local))) || (0 != listen(fd, 64)))
+                      : (0 != connect(fd, (struct sockaddr *)&local, sizeof(local))))
+        {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    if ((size_t)(port - address) >= sizeof(host))
+    {
+        return -1;
+    }
+    memcpy(host, address, (size_t)(port - address));
+    host[port - address] = '\0';
+    ++port;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listening ? AI_PASSIVE : 0;
+    if (0 != getaddrinfo(('\0' != host[0]) && (0 != strcmp(host, "*")) ? host : NULL, port, &hints, &addresses))
+    {
+        return -1;
+    }
+
+    for (entry = addresses; NULL != entry; entry = entry->ai_next)
+    {
+        fd = socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+        if (-1 == fd)
+        {
+            continue;
+        }
+        if (listening)
+        {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        }
+        if (listening ? ((0 == bind(fd, entry->ai_addr, entry->ai_addrlen)) && (0 == listen(fd, 64)))
+                      : (0 == connect(fd, entry->ai_addr, entry->ai_addrlen)))
+        {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+
+    return fd;
+}
+
+static int SendLine(int fd, const char *line)
+{
+    char buffer[SHARD_LINE_SIZE];
+    size_t length = (size_t)snprintf(buffer, sizeof(buffer), "%s\n", line);
+    size_t sent = 0;
+    ssize_t result = 0;
+
+    while (sent < length)
+    {
+        result = send(fd, buffer + sent, length - sent, MSG_NOSIGNAL);
+        if (0 >= result)
+        {
+            return 1;
+        }
+        sent += (size_t)result;
+    }
+
+    return 0;
+}
+
+static int QueueShardLine(shard_client_t *client, const char *line)
+{
+    size_t length = strlen(line);
+
+    /* A worker that leaves a whole buffer of replies unread is not following the protocol */
+    if (length + 1 > sizeof(client->output) - client->output_length)
+    {
+        return 1;
+    }
+
+    memcpy(client->output + client->output_length, line, length);
+    client->output[client->output_length + length] = '\n';
+    client->output_length += length + 1;
+
+    return 0;
+}
+
+static int FlushShardOutput(shard_client_t *client)
+{
+    size_t sent = 0;
+    ssize_t result = 0;
+
+    while (sent < client->output_length)
+    {
+        result = send(client->fd, client->output + sent, client->output_length - sent, MSG_NOSIGNAL);
+        if (0 >= result)
+        {
+            break;
+        }
+        sent += (size_t)result;
+    }
+
+    memmove(client->output, client->output + sent, client->output_length - sent);
+    client->output_length -= sent;
+
+    /* The socket is non-blocking: a full send buffer just leaves the rest for the next POLLOUT */
+    return (0 > result) && (EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno);
+}
+
+static int SendPuzzle(int fd, unsigned long range, const unsigned char *puzzle)
+{
+    char line[SHARD_LINE_SIZE];
+    int length = snprintf(line, sizeof(line), "PUZZLE %lu ", range);
+    size_t cell = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        line[length + cell] = (char)('0' + puzzle[cell]);
+    }
+    line[length + SUDOKU_CELLS] = '\0';
+
+    return SendLine(fd, line);
+}
+
+static int ReceiveLine(int fd, char *input, size_t *input_length, char *line)
+{
+    ssize_t received = 0;
+
+    while (!TakeLine(input, input_length, line))
+    {
+        if (SHARD_INPUT_SIZE == *input_length)
+        {
+            return 0;
+        }
+        received = recv(fd, input + *input_length, SHARD_INPUT_SIZE - *input_length, 0);
+        if (0 >= received)
+        {
+            return 0;
+        }
+        *input_length += (size_t)received;
+    }
+
+    return 1;
+}
+
+static int TakeLine(char *input, size_t *input_length, char *line)
+{
+    char *end = memchr(input, '\n', *input_length);
+    size_t length = 0;
+
+    if (NULL == end)
+    {
+        return 0;
+    }
+
+    /* Lines too long for any message are cut, and then rejected as unexpected */
+    length = (size_t)(end - input);
+    memcpy(line, input, (SHARD_LINE_SIZE > length) ? length : SHARD_LINE_SIZE - 1);
+    line[(SHARD_LINE_SIZE > length) ? length : SHARD_LINE_SIZE - 1] = '\0';
+    *input_length -= length + 1;
+    memmove(input, end + 1, *input_length);
+
+    return 1;
+}
+
+static int ParsePuzzle(const char *line, unsigned char *puzzle)
+{
+    size_t cell = 0;
+
+    /* Lines that are not 81 cells long (comments, blank lines) are skipped */
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if ('.' == line[cell])
+        {
+            puzzle[cell] = 0;
+        }
+        else if (('0' <= line[cell]) && ('9' >= line[cell]))
+        {
+            puzzle[cell] = (unsigned char)(line[cell] - '0');
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void PrintPuzzle(FILE *file, const unsigned char *puzzle)
+{
+    size_t cell = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        fputc((0 != puzzle[cell]) ? '0' + puzzle[cell] : '.', file);
+    }
+    fputc('\n', file);
+}
+
+static size_t ClampThreadCount(size_t thread_count)
+{
+    /* Too many threads use as many as there are slots, a count that does not parse uses one */
+    if (TOOL_MAX_THREADS < thread_count)
+    {
+        return TOOL_MAX_THREADS;
+    }
+
+    return (0 == thread_count) ? 1 : thread_count;
+}
+
+static size_t StartThreads(pthread_t *threads, size_t thread_count, void *(*worker)(void *), void *job)
+{
+    size_t i = 0;
+    int error = 0;
+
+    /* Carry on with the threads that started; only those may be joined */
+    for (i = 0; i < thread_count; ++i)
+    {
+        error = pthread_create(&threads[i], NULL, worker, job);
+        if (0 != error)
+        {
+            fprintf(stderr, "Cannot start thread %lu: %s.\n", (unsigned long)(i + 1), strerror(error));
+            break;
+        }
+    }
+
+    return i;
+}
+
+static double GetSeconds()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static void PrintUsage(const char *program)
+{
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s pack <puzzle-file> <archive>   Pack 81-character puzzle lines into an archive\n", program);
+    fprintf(stderr, "  %s unpack <archive>               Print the puzzles of an archive\n", program);
+    fprintf(stderr, "  %s solve <archive> [threads]      Decode and batch-solve an archive in parallel\n", program);
+    fprintf(stderr, "  %s search <archive> [threads] [seconds] [max-clues] [seed]\n", program);
+    fprintf(stderr, "      Search for certified minimal puzzles with at most max-clues clues (default %d);\n",
+            SEARCH_MAX_CLUES);
+    fprintf(stderr, "      write them to puzzles.sdka for the extreme level\n");
+    fprintf(stderr, "  %s serve <archive> <address> [seeds] [range-size] [max-clues] [first-seed]\n", program);
+    fprintf(stderr, "      Lease ranges of up to %d seeds to workers and merge their puzzles into one archive\n",
+            SHARD_MAX_RANGE_SIZE);
+    fprintf(stderr, "  %s work <address>                Search the seed ranges leased by a coordinator\n", program);
+    fprintf(stderr, "      An address is host:port for TCP or the path of a Unix socket\n");
+}
@@ -0,0 +1,64 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#include "sudoku.h"
+#include "sudoku_util.h"
+
+/*  =================================   */
+/*  API Functions Implementation        */
+/*  =================================   */
+unsigned long long SudokuHashPuzzle(const unsigned char *puzzle)
+{
+    unsigned long long hash = 14695981039346656037ULL; /* FNV-1a offset basis */
+    size_t cell = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        hash ^= puzzle[cell];
+        hash *= 1099511628211ULL; /* FNV-1a prime */
+    }
+
+    return (0 != hash) ? hash : 1;
+}
+
+unsigned int SudokuCountBits(unsigned int mask)
+{
+    unsigned int count = 0;
+
+    while (0 != mask)
+    {
+        mask &= mask - 1;
+        ++count;
+    }
+
+    return count;
+}
+
+uint32_t SudokuChecksum(const unsigned char *data, size_t size)
+{
+    uint32_t hash = 2166136261U; /* FNV-1a offset basis */
+    size_t i = 0;
+
+    for (i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 16777619U; /* FNV-1a prime */
+    }
+
+    return hash;
+}
+
+void SudokuPutUInt32(unsigned char *bytes, uint32_t value)
+{
+    bytes[0] = (unsigned char)(value & 0xFF);
+    bytes[1] = (unsigned char)((value >> 8) & 0xFF);
+    bytes[2] = (unsigned char)((value >> 16) & 0xFF);
+    bytes[3] = (unsigned char)((value >> 24) & 0xFF);
+}
+
+uint32_t SudokuGetUInt32(const unsigned char *bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
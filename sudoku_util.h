@@ -0,0 +1,46 @@
+/**
+ * @file sudoku_util.h
+ * @brief Sudoku Shared Helpers
+ *
+ * This header file provides the small helpers shared by the cache,
+ * archive, batch solver, hint engine and tools, kept in one place so
+ * their copies cannot drift apart. It is internal to the project and
+ * not part of the game interface.
+ *
+ * @author [Zayd Abu Sneineh]
+ */
+
+#ifndef SUDOKU_UTIL_H
+#define SUDOKU_UTIL_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint32_t */
+
+/**
+ * @brief Hash the 81 cells of a puzzle (FNV-1a).
+ *
+ * @return The hash, never 0 so that 0 can mark free slots.
+ */
+unsigned long long SudokuHashPuzzle(const unsigned char *puzzle);
+
+/**
+ * @brief Count the digits set in a candidate mask.
+ */
+unsigned int SudokuCountBits(unsigned int mask);
+
+/**
+ * @brief Checksum a run of bytes in a file (32-bit FNV-1a).
+ */
+uint32_t SudokuChecksum(const unsigned char *data, size_t size);
+
+/**
+ * @brief Store a 32-bit value as four little-endian bytes.
+ */
+void SudokuPutUInt32(unsigned char *bytes, uint32_t value);
+
+/**
+ * @brief Read a 32-bit value stored as four little-endian bytes.
+ */
+uint32_t SudokuGetUInt32(const unsigned char *bytes);
+
+#endif /* SUDOKU_UTIL_H */
@@ -0,0 +1,587 @@
+/*  ==================================  */
+/*    * Developer: Zayd Abu Sneineh     */
+/*    * Date     : Jan 16 2024          */
+/* ===================================  */
+
+#include <stdlib.h> /* calloc, malloc, free */
+#include <string.h> /* memcpy, memset, strcpy, strcat */
+
+#include "sudoku.h"
+#include "sudoku_variant.h"
+
+#define VARIANT_DIMENSION 9
+#define VARIANT_MAX_CELL_UNITS 7 /* Row, column, box, two diagonals, window, cage */
+#define VARIANT_MAX_PEERS 64
+#define VARIANT_ALL_DIGITS 0x1FF
+#define VARIANT_MAX_SUM 45
+#define VARIANT_NO_CAGE 0xFF
+/*  ==================================  */
+/*  ENUMERATIONS & TYPES                */
+/*  ==================================  */
+struct Sudoku_Variant
+{
+    /* The rules as given */
+    unsigned int rules;
+    int has_regions;
+    unsigned char regions[SUDOKU_CELLS];
+    size_t cage_count;
+    unsigned char cage_cells[SUDOKU_VARIANT_MAX_CAGES][VARIANT_DIMENSION];
+    unsigned char cage_size[SUDOKU_VARIANT_MAX_CAGES];
+    unsigned char cage_sum[SUDOKU_VARIANT_MAX_CAGES];
+    char name[48];
+
+    /* The rules compiled to flat tables */
+    size_t unit_count;
+    unsigned char unit_kind[SUDOKU_VARIANT_MAX_UNITS];
+    unsigned char unit_size[SUDOKU_VARIANT_MAX_UNITS];
+    unsigned char unit_sum[SUDOKU_VARIANT_MAX_UNITS];
+    unsigned char unit_cells[SUDOKU_VARIANT_MAX_UNITS][VARIANT_DIMENSION];
+    unsigned char cell_unit_count[SUDOKU_CELLS];
+    unsigned char cell_units[SUDOKU_CELLS][VARIANT_MAX_CELL_UNITS];
+    unsigned char cell_cage[SUDOKU_CELLS];
+    unsigned char peer_count[SUDOKU_CELLS];
+    unsigned char peers[SUDOKU_CELLS][VARIANT_MAX_PEERS];
+
+    /* Every set of distinct digits, grouped by size and then by sum */
+    unsigned short combinations[VARIANT_ALL_DIGITS + 1];
+    unsigned short combination_start[(VARIANT_DIMENSION + 1) * (VARIANT_MAX_SUM + 1) + 1];
+
+    /* The board */
+    unsigned char value[SUDOKU_CELLS];
+    unsigned short used[SUDOKU_VARIANT_MAX_UNITS];
+    int sum_left[SUDOKU_VARIANT_MAX_UNITS];
+    unsigned char cells_left[SUDOKU_VARIANT_MAX_UNITS];
+};
+
+/*  ==================================  */
+/*  Daclaration Static Functions        */
+/*  ==================================  */
+static void BuildCombinations(sudoku_variant_t *variant);
+static void CompileUnits(sudoku_variant_t *variant);
+static void AddUnit(sudoku_variant_t *variant, enum unit_kind kind, const unsigned char *cells, size_t count, unsigned int sum);
+static void BuildPeers(sudoku_variant_t *variant);
+static void BuildName(sudoku_variant_t *variant);
+static void ClearBoard(sudoku_variant_t *variant);
+static unsigned int GetCageDigits(const sudoku_variant_t *variant, size_t unit);
+static size_t GetCombinationKey(size_t count, size_t sum);
+
+/*  =================================   */
+/*  API Functions Implementation        */
+/*  =================================   */
+sudoku_variant_t *SudokuVariantCreate(unsigned int rules)
+{
+    sudoku_variant_t *variant = (sudoku_variant_t *)calloc(1, sizeof(sudoku_variant_t));
+    if (NULL == variant)
+    {
+        return NULL;
+    }
+
+    variant->rules = rules & (VARIANT_DIAGONAL | VARIANT_WINDOKU);
+
+    BuildCombinations(variant);
+    CompileUnits(variant);
+
+    return variant;
+}
+
+sudoku_variant_t *SudokuVariantClone(const sudoku_variant_t *variant)
+{
+    sudoku_variant_t *clone = (sudoku_variant_t *)malloc(sizeof(sudoku_variant_t));
+    if (NULL == clone)
+    {
+        return NULL;
+    }
+
+    memcpy(clone, variant, sizeof(sudoku_variant_t));
+
+    return clone;
+}
+
+void SudokuVariantDestroy(sudoku_variant_t *variant)
+{
+    free(variant);
+    variant = NULL;
+}
+
+int SudokuVariantSetRegions(sudoku_variant_t *variant, const unsigned char *regions)
+{
+    size_t region_size[VARIANT_DIMENSION] = {0};
+    size_t cell = 0;
+    size_t region = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (VARIANT_DIMENSION <= regions[cell])
+        {
+            return 1;
+        }
+        ++region_size[regions[cell]];
+    }
+
+    for (region = 0; region < VARIANT_DIMENSION; ++region)
+    {
+        if (VARIANT_DIMENSION != region_size[region])
+        {
+            return 1;
+        }
+    }
+
+    memcpy(variant->regions, regions, SUDOKU_CELLS);
+    variant->has_regions = 1;
+
+    CompileUnits(variant);
+
+    return 0;
+}
+
+int SudokuVariantAddCage(sudoku_variant_t *variant, const unsigned char *cells, size_t count, unsigned int sum)
+{
+    unsigned char taken[SUDOKU_CELLS] = {0};
+    size_t key = 0;
+    size_t i = 0;
+
+    if ((SUDOKU_VARIANT_MAX_CAGES == variant->cage_count) || (0 == count) || (VARIANT_DIMENSION < count) ||
+        (VARIANT_MAX_SUM < sum))
+    {
+        return 1;
+    }
+
+    /* No set of distinct digits of that size adds up to the sum */
+    key = GetCombinationKey(count, sum);
+    if (variant->combination_start[key] == variant->combination_start[key + 1])
+    {
+        return 1;
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        if ((SUDOKU_CELLS <= cells[i]) || (taken[cells[i]]) || (VARIANT_NO_CAGE != variant->cell_cage[cells[i]]))
+        {
+            return 1;
+        }
+        taken[cells[i]] = 1;
+    }
+
+    memcpy(variant->cage_cells[variant->cage_count], cells, count);
+    variant->cage_size[variant->cage_count] = (unsigned char)count;
+    variant->cage_sum[variant->cage_count] = (unsigned char)sum;
+    ++variant->cage_count;
+
+    CompileUnits(variant);
+
+    return 0;
+}
+
+int SudokuVariantIsClassic(const sudoku_variant_t *variant)
+{
+    return (VARIANT_CLASSIC == variant->rules) && (!variant->has_regions) && (0 == variant->cage_count);
+}
+
+const char *SudokuVariantName(const sudoku_variant_t *variant)
+{
+    return variant->name;
+}
+
+size_t SudokuVariantUnitCount(const sudoku_variant_t *variant)
+{
+    return variant->unit_count;
+}
+
+enum unit_kind SudokuVariantUnitKind(const sudoku_variant_t *variant, size_t unit)
+{
+    return (enum unit_kind)variant->unit_kind[unit];
+}
+
+size_t SudokuVariantUnitCells(const sudoku_variant_t *variant, size_t unit, const unsigned char **cells)
+{
+    *cells = variant->unit_cells[unit];
+
+    return variant->unit_size[unit];
+}
+
+size_t SudokuVariantCellUnits(const sudoku_variant_t *variant, size_t cell, const unsigned char **units)
+{
+    *units = variant->cell_units[cell];
+
+    return variant->cell_unit_count[cell];
+}
+
+size_t SudokuVariantPeers(const sudoku_variant_t *variant, size_t cell, const unsigned char **peers)
+{
+    *peers = variant->peers[cell];
+
+    return variant->peer_count[cell];
+}
+
+int SudokuVariantLoad(sudoku_variant_t *variant, const unsigned char *cells)
+{
+    size_t cell = 0;
+    int broken = 0;
+
+    ClearBoard(variant);
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        if (0 != cells[cell])
+        {
+            broken |= !SudokuVariantIsLegal(variant, cell, cells[cell]);
+            SudokuVariantSetCell(variant, cell, cells[cell]);
+        }
+    }
+
+    return broken;
+}
+
+void SudokuVariantSetCell(sudoku_variant_t *variant, size_t cell, unsigned int digit)
+{
+    size_t i = 0;
+    size_t unit = 0;
+
+    if ((0 != variant->value[cell]) || (0 == digit) || (VARIANT_DIMENSION < digit))
+    {
+        return;
+    }
+
+    variant->value[cell] = (unsigned char)digit;
+    for (i = 0; i < variant->cell_unit_count[cell]; ++i)
+    {
+        variant->used[variant->cell_units[cell][i]] |= (unsigned short)(1 << (digit - 1));
+    }
+
+    unit = variant->cell_cage[cell];
+    if (VARIANT_NO_CAGE != unit)
+    {
+        variant->sum_left[unit] -= (int)digit;
+        --variant->cells_left[unit];
+    }
+}
+
+void SudokuVariantClearCell(sudoku_variant_t *variant, size_t cell)
+{
+    unsigned int digit = variant->value[cell];
+    size_t i = 0;
+    size_t unit = 0;
+
+    if (0 == digit)
+    {
+        return;
+    }
+
+    variant->value[cell] = 0;
+    for (i = 0; i < variant->cell_unit_count[cell]; ++i)
+    {
+        variant->used[variant->cell_units[cell][i]] &= (unsigned short)~(1 << (digit - 1));
+    }
+
+    unit = variant->cell_cage[cell];
+    if (VARIANT_NO_CAGE != unit)
+    {
+        variant->sum_left[unit] += (int)digit;
+        ++variant->cells_left[unit];
+    }
+}
+
+unsigned int SudokuVariantCandidates(const sudoku_variant_t *variant, size_t cell)
+{
+    unsigned int used = 0;
+    unsigned int candidates = 0;
+    size_t i = 0;
+
+    if (0 != variant->value[cell])
+    {
+        return 0;
+    }
+
+    /* One mask test per unit; classic cells have exactly three */
+    for (i = 0; i < variant->cell_unit_count[cell]; ++i)
+    {
+        used |= variant->used[variant->cell_units[cell][i]];
+    }
+    candidates = VARIANT_ALL_DIGITS & ~used;
+
+    if ((0 != candidates) && (VARIANT_NO_CAGE != variant->cell_cage[cell]))
+    {
+        candidates &= GetCageDigits(variant, variant->cell_cage[cell]);
+    }
+
+    return candidates;
+}
+
+int SudokuVariantIsLegal(const sudoku_variant_t *variant, size_t cell, unsigned int digit)
+{
+    if ((0 == digit) || (VARIANT_DIMENSION < digit))
+    {
+        return 0;
+    }
+
+    return (0 != (SudokuVariantCandidates(variant, cell) & (1 << (digit - 1))));
+}
+
+/*  =================================   */
+/*  Static Functions Implementation     */
+/*  =================================   */
+static void BuildCombinations(sudoku_variant_t *variant)
+{
+    size_t fill[(VARIANT_DIMENSION + 1) * (VARIANT_MAX_SUM + 1)];
+    size_t key_of[VARIANT_ALL_DIGITS + 1];
+    size_t mask = 0;
+    size_t digit = 0;
+    size_t count = 0;
+    size_t sum = 0;
+    size_t key = 0;
+
+    for (key = 0; key < sizeof(variant->combination_start) / sizeof(variant->combination_start[0]); ++key)
+    {
+        variant->combination_start[key] = 0;
+    }
+
+    /* Count the sets of every size and sum, then lay them out in that order */
+    for (mask = 0; mask <= VARIANT_ALL_DIGITS; ++mask)
+    {
+        count = 0;
+        sum = 0;
+        for (digit = 1; digit <= VARIANT_DIMENSION; ++digit)
+        {
+            if (mask & (1u << (digit - 1)))
+            {
+                ++count;
+                sum += digit;
+            }
+        }
+
+        key_of[mask] = GetCombinationKey(count, sum);
+        ++variant->combination_start[key_of[mask] + 1];
+    }
+
+    for (key = 0; key < (VARIANT_DIMENSION + 1) * (VARIANT_MAX_SUM + 1); ++key)
+    {
+        variant->combination_start[key + 1] += variant->combination_start[key];
+        fill[key] = variant->combination_start[key];
+    }
+
+    for (mask = 0; mask <= VARIANT_ALL_DIGITS; ++mask)
+    {
+        variant->combinations[fill[key_of[mask]]++] = (unsigned short)mask;
+    }
+}
+
+static void CompileUnits(sudoku_variant_t *variant)
+{
+    unsigned char cells[VARIANT_DIMENSION];
+    size_t row = 0;
+    size_t col = 0;
+    size_t cell = 0;
+    size_t unit = 0;
+    size_t count = 0;
+    size_t i = 0;
+
+    variant->unit_count = 0;
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        variant->cell_unit_count[cell] = 0;
+        variant->cell_cage[cell] = VARIANT_NO_CAGE;
+    }
+
+    for (row = 0; row < VARIANT_DIMENSION; ++row)
+    {
+        for (col = 0; col < VARIANT_DIMENSION; ++col)
+        {
+            cells[col] = (unsigned char)(row * VARIANT_DIMENSION + col);
+        }
+        AddUnit(variant, UNIT_ROW, cells, VARIANT_DIMENSION, VARIANT_MAX_SUM);
+    }
+
+    for (col = 0; col < VARIANT_DIMENSION; ++col)
+    {
+        for (row = 0; row < VARIANT_DIMENSION; ++row)
+        {
+            cells[row] = (unsigned char)(row * VARIANT_DIMENSION + col);
+        }
+        AddUnit(variant, UNIT_COL, cells, VARIANT_DIMENSION, VARIANT_MAX_SUM);
+    }
+
+    for (unit = 0; unit < VARIANT_DIMENSION; ++unit)
+    {
+        count = 0;
+        for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+        {
+            if ((variant->has_regions) ? (unit == variant->regions[cell])
+                                       : (unit == (cell / 27) * 3 + (cell % VARIANT_DIMENSION) / 3))
+            {
+                cells[count++] = (unsigned char)cell;
+            }
+        }
+        AddUnit(variant, (variant->has_regions) ? UNIT_REGION : UNIT_BOX, cells, count, VARIANT_MAX_SUM);
+    }
+
+    if (variant->rules & VARIANT_DIAGONAL)
+    {
+        for (i = 0; i < VARIANT_DIMENSION; ++i)
+        {
+            cells[i] = (unsigned char)(i * (VARIANT_DIMENSION + 1));
+        }
+        AddUnit(variant, UNIT_DIAGONAL, cells, VARIANT_DIMENSION, VARIANT_MAX_SUM);
+
+        for (i = 0; i < VARIANT_DIMENSION; ++i)
+        {
+            cells[i] = (unsigned char)((i + 1) * (VARIANT_DIMENSION - 1));
+        }
+        AddUnit(variant, UNIT_DIAGONAL, cells, VARIANT_DIMENSION, VARIANT_MAX_SUM);
+    }
+
+    if (variant->rules & VARIANT_WINDOKU)
+    {
+        /* The windows start at rows and columns 1 and 5 */
+        for (unit = 0; unit < 4; ++unit)
+        {
+            for (i = 0; i < VARIANT_DIMENSION; ++i)
+            {
+                row = 1 + (unit / 2) * 4 + i / 3;
+                col = 1 + (unit % 2) * 4 + i % 3;
+                cells[i] = (unsigned char)(row * VARIANT_DIMENSION + col);
+            }
+            AddUnit(variant, UNIT_WINDOW, cells, VARIANT_DIMENSION, VARIANT_MAX_SUM);
+        }
+    }
+
+    for (i = 0; i < variant->cage_count; ++i)
+    {
+        AddUnit(variant, UNIT_CAGE, variant->cage_cells[i], variant->cage_size[i], variant->cage_sum[i]);
+    }
+
+    BuildPeers(variant);
+    BuildName(variant);
+    ClearBoard(variant);
+}
+
+static void AddUnit(sudoku_variant_t *variant, enum unit_kind kind, const unsigned char *cells, size_t count, unsigned int sum)
+{
+    size_t unit = variant->unit_count++;
+    size_t cell = 0;
+    size_t i = 0;
+
+    variant->unit_kind[unit] = (unsigned char)kind;
+    variant->unit_size[unit] = (unsigned char)count;
+    variant->unit_sum[unit] = (unsigned char)sum;
+
+    for (i = 0; i < count; ++i)
+    {
+        cell = cells[i];
+        variant->unit_cells[unit][i] = (unsigned char)cell;
+        variant->cell_units[cell][variant->cell_unit_count[cell]++] = (unsigned char)unit;
+
+        if (UNIT_CAGE == kind)
+        {
+            variant->cell_cage[cell] = (unsigned char)unit;
+        }
+    }
+}
+
+static void BuildPeers(sudoku_variant_t *variant)
+{
+    unsigned char seen[SUDOKU_CELLS];
+    size_t cell = 0;
+    size_t unit = 0;
+    size_t peer = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        memset(seen, 0, sizeof(seen));
+        seen[cell] = 1;
+        variant->peer_count[cell] = 0;
+
+        for (i = 0; i < variant->cell_unit_count[cell]; ++i)
+        {
+            unit = variant->cell_units[cell][i];
+            for (j = 0; j < variant->unit_size[unit]; ++j)
+            {
+                peer = variant->unit_cells[unit][j];
+                if (!seen[peer])
+                {
+                    seen[peer] = 1;
+                    variant->peers[cell][variant->peer_count[cell]++] = (unsigned char)peer;
+                }
+            }
+        }
+    }
+}
+
+static void BuildName(sudoku_variant_t *variant)
+{
+    const char *words[4];
+    size_t count = 0;
+    size_t i = 0;
+
+    if (variant->rules & VARIANT_DIAGONAL)
+    {
+        words[count++] = "diagonal";
+    }
+    if (variant->rules & VARIANT_WINDOKU)
+    {
+        words[count++] = "windoku";
+    }
+    if (variant->has_regions)
+    {
+        words[count++] = "jigsaw";
+    }
+    if (0 != variant->cage_count)
+    {
+        words[count++] = "killer";
+    }
+
+    strcpy(variant->name, (0 == count) ? "classic" : words[0]);
+    for (i = 1; i < count; ++i)
+    {
+        strcat(variant->name, " ");
+        strcat(variant->name, words[i]);
+    }
+}
+
+static void ClearBoard(sudoku_variant_t *variant)
+{
+    size_t cell = 0;
+    size_t unit = 0;
+
+    for (cell = 0; cell < SUDOKU_CELLS; ++cell)
+    {
+        variant->value[cell] = 0;
+    }
+
+    for (unit = 0; unit < variant->unit_count; ++unit)
+    {
+        variant->used[unit] = 0;
+        variant->sum_left[unit] = variant->unit_sum[unit];
+        variant->cells_left[unit] = variant->unit_size[unit];
+    }
+}
+
+static unsigned int GetCageDigits(const sudoku_variant_t *variant, size_t unit)
+{
+    unsigned int digits = 0;
+    size_t key = 0;
+    size_t i = 0;
+
+    if ((0 > variant->sum_left[unit]) || (VARIANT_MAX_SUM < variant->sum_left[unit]))
+    {
+        return 0;
+    }
+
+    /* Keep the digits of every set of unused digits that completes the cage */
+    key = GetCombinationKey(variant->cells_left[unit], (size_t)variant->sum_left[unit]);
+    for (i = variant->combination_start[key]; i < variant->combination_start[key + 1]; ++i)
+    {
+        if (0 == (variant->combinations[i] & variant->used[unit]))
+        {
+            digits |= variant->combinations[i];
+        }
+    }
+
+    return digits;
+}
+
+static size_t GetCombinationKey(size_t count, size_t sum)
+{
+    return count * (VARIANT_MAX_SUM + 1) + sum;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file sudoku_variant.h
+ * @brief Sudoku Variant Rules Interface
+ *
+ * This header file provides the interface for the constraint engine
+ * behind the legality checks. The rules of a variant (classic, diagonal,
+ * windoku, jigsaw regions, killer cages) are compiled once into flat
+ * tables: the cells of every unit, the units of every cell and the peers
+ * of every cell. The engine also keeps a mask of the digits used in every
+ * unit, so checking a digit costs one mask test per unit of the cell:
+ * three for classic Sudoku, plus one for each extra unit the cell is in.
+ *
+ * Killer cages also keep the sum still missing, and their candidates are
+ * limited to the digits that appear in some set of unused digits that
+ * completes the cage.
+ *
+ * @author [Zayd Abu Sneineh]
+ */
+
+#ifndef SUDOKU_VARIANT_H
+#define SUDOKU_VARIANT_H
+
+#include <stddef.h> /* size_t */
+
+/**
+ * @def SUDOKU_VARIANT_MAX_CAGES
+ * Maximum number of killer cages in a variant.
+ */
+#define SUDOKU_VARIANT_MAX_CAGES 81
+
+/**
+ * @def SUDOKU_VARIANT_MAX_UNITS
+ * Maximum number of units in a variant: rows, columns, boxes or
+ * regions, diagonals, windows and cages.
+ */
+#define SUDOKU_VARIANT_MAX_UNITS (27 + 2 + 4 + SUDOKU_VARIANT_MAX_CAGES)
+
+/**
+ * @enum variant_rule
+ * Rules that can be combined when creating a variant.
+ * Jigsaw regions and killer cages are added with their own functions.
+ */
+enum variant_rule
+{
+    VARIANT_CLASSIC = 0,
+    VARIANT_DIAGONAL = 1, /* Both main diagonals hold every digit once (X-Sudoku) */
+    VARIANT_WINDOKU = 2   /* Four extra 3x3 windows hold every digit once */
+};
+
+/**
+ * @enum unit_kind
+ * Enumeration for the kinds of units a variant is made of.
+ */
+enum unit_kind
+{
+    UNIT_ROW = 0,
+    UNIT_COL = 1,
+    UNIT_BOX = 2,
+    UNIT_REGION = 3,   /* Jigsaw region, replaces the boxes */
+    UNIT_DIAGONAL = 4,
+    UNIT_WINDOW = 5,
+    UNIT_CAGE = 6      /* Killer cage: distinct digits adding up to its sum */
+};
+
+/**
+ * @typedef sudoku_variant_t
+ * Typedef for the variant structure.
+ * The structure is defined in the implementation file.
+ */
+typedef struct Sudoku_Variant sudoku_variant_t;
+
+/**
+ * @brief Create a variant with an empty board.
+ *
+ * @param rules VARIANT_CLASSIC or a combination of enum variant_rule flags.
+ * @return The new variant, or NULL if the allocation failed.
+ */
+sudoku_variant_t *SudokuVariantCreate(unsigned int rules);
+
+/**
+ * @brief Create a copy of a variant, including its board.
+ *
+ * @return The copy, or NULL if the allocation failed.
+ */
+sudoku_variant_t *SudokuVariantClone(const sudoku_variant_t *variant);
+
+/**
+ * @brief Free a variant.
+ */
+void SudokuVariantDestroy(sudoku_variant_t *variant);
+
+/**
+ * @brief Replace the 3x3 boxes with jigsaw regions.
+ *
+ * The board is cleared.
+ *
+ * @param regions 81 region numbers (0-8) in row-major order, nine cells each.
+ * @return 0 on success, 1 if the regions are not valid.
+ */
+int SudokuVariantSetRegions(sudoku_variant_t *variant, const unsigned char *regions);
+
+/**
+ * @brief Add a killer cage.
+ *
+ * The board is cleared.
+ *
+ * @param cells Cell numbers (row * 9 + col) of the cage, none in another cage.
+ * @param count Number of cells, 1 to 9.
+ * @param sum Sum of the digits of the cage.
+ * @return 0 on success, 1 if the cage is not valid or no sum of distinct
+ *         digits can fill it.
+ */
+int SudokuVariantAddCage(sudoku_variant_t *variant, const unsigned char *cells, size_t count, unsigned int sum);
+
+/**
+ * @brief Check whether a variant has only the classic rules.
+ *
+ * @return 1 for classic Sudoku, 0 otherwise.
+ */
+int SudokuVariantIsClassic(const sudoku_variant_t *variant);
+
+/**
+ * @brief Get a readable name for the rules of a variant.
+ */
+const char *SudokuVariantName(const sudoku_variant_t *variant);
+
+/**
+ * @brief Get the number of units of a variant.
+ */
+size_t SudokuVariantUnitCount(const sudoku_variant_t *variant);
+
+/**
+ * @brief Get the kind of a unit.
+ */
+enum unit_kind SudokuVariantUnitKind(const sudoku_variant_t *variant, size_t unit);
+
+/**
+ * @brief Get the cells of a unit.
+ *
+ * @param cells Receives a pointer to the cell numbers.
+ * @return Number of cells.
+ */
+size_t SudokuVariantUnitCells(const sudoku_variant_t *variant, size_t unit, const unsigned char **cells);
+
+/**
+ * @brief Get the units a cell belongs to.
+ *
+ * @param units Receives a pointer to the unit numbers.
+ * @return Number of units.
+ */
+size_t SudokuVariantCellUnits(const sudoku_variant_t *variant, size_t cell, const unsigned char **units);
+
+/**
+ * @brief Get the cells that share a unit with a cell.
+ *
+ * @param peers Receives a pointer to the cell numbers.
+ * @return Number of peers.
+ */
+size_t SudokuVariantPeers(const sudoku_variant_t *variant, size_t cell, const unsigned char **peers);
+
+/**
+ * @brief Replace the board of a variant.
+ *
+ * @param cells 81 cells in row-major order, 0 for empty cells.
+ * @return 0 if every digit was legal when placed, 1 otherwise.
+ */
+int SudokuVariantLoad(sudoku_variant_t *variant, const unsigned char *cells);
+
+/**
+ * @brief Place a digit in an empty cell, without checking it.
+ */
+void SudokuVariantSetCell(sudoku_variant_t *variant, size_t cell, unsigned int digit);
+
+/**
+ * @brief Empty a cell.
+ */
+void SudokuVariantClearCell(sudoku_variant_t *variant, size_t cell);
+
+/**
+ * @brief Get the digits that can go in a cell.
+ *
+ * @return A mask where bit (digit - 1) is set for every legal digit,
+ *         or 0 for a filled cell.
+ */
+unsigned int SudokuVariantCandidates(const sudoku_variant_t *variant, size_t cell);
+
+/**
+ * @brief Check whether a digit can go in an empty cell.
+ *
+ * @return 1 if the digit breaks no rule, 0 otherwise.
+ */
+int SudokuVariantIsLegal(const sudoku_variant_t *variant, size_t cell, unsigned int digit);
+
+#endif /* SUDOKU_VARIANT_H */